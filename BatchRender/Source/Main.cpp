@@ -0,0 +1,346 @@
+/*
+  ==============================================================================
+
+    Headless batch renderer for LemonDriveAudioProcessor.
+
+    Applies one preset or saved state to every WAV/AIFF/FLAC file in a folder
+    and writes the results, in the same format and bit depth, to another:
+
+      LemonDriveBatch --input=stems --output=driven [--preset=name|index]
+                      [--state=session.state] [--threads=8] [--block=4096]
+                      [--recursive]
+
+    Each file is streamed through processBlock in --block sized chunks, so
+    memory use doesn't depend on file length. Output is latency compensated
+    and keeps the input's length.
+
+    Files are spread over a work-stealing pool with one processor per worker.
+    Every file starts from a freshly prepared processor and is cut into the
+    same chunks whichever worker renders it, so the output is bit-identical
+    to a --threads=1 run.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+#include <iostream>
+
+//==============================================================================
+namespace
+{
+    struct Job
+    {
+        juce::File source, destination;
+        juce::int64 size = 0;
+    };
+
+    struct RenderResult
+    {
+        juce::String error;
+        double audioSeconds = 0.0;
+    };
+
+    /** One worker's deque: the owner takes from the front, thieves from the back. */
+    class JobQueue
+    {
+    public:
+        void push (int job)
+        {
+            const juce::ScopedLock sl (lock);
+            jobs.push_back (job);
+        }
+
+        bool popFront (int& job)
+        {
+            const juce::ScopedLock sl (lock);
+
+            if (jobs.empty())
+                return false;
+
+            job = jobs.front();
+            jobs.pop_front();
+            return true;
+        }
+
+        bool stealBack (int& job)
+        {
+            const juce::ScopedLock sl (lock);
+
+            if (jobs.empty())
+                return false;
+
+            job = jobs.back();
+            jobs.pop_back();
+            return true;
+        }
+
+    private:
+        juce::CriticalSection lock;
+        std::deque<int> jobs;
+    };
+
+    //==============================================================================
+    RenderResult renderFile (LemonDriveAudioProcessor& processor, juce::AudioFormatManager& formats,
+                             const Job& job, int blockSize)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (job.source));
+
+        if (reader == nullptr)
+            return { "can't read file" };
+
+        auto numChannels = (int) reader->numChannels;
+        auto channelSet = juce::AudioChannelSet::canonicalChannelSet (numChannels);
+
+        if (channelSet.isDisabled())
+            channelSet = juce::AudioChannelSet::discreteChannels (numChannels);
+
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add (channelSet);
+        layout.inputBuses.add (juce::AudioChannelSet::disabled());   // sidechain
+        layout.outputBuses.add (channelSet);
+
+        if (! processor.setBusesLayout (layout))
+            return { "unsupported channel count " + juce::String (numChannels) };
+
+        // same format and bit depth as the source; FLAC tops out at 24 bits
+        auto* format = formats.findFormatForFileExtension (job.source.getFileExtension());
+        auto bitsPerSample = (int) reader->bitsPerSample;
+
+        if (format == nullptr || ! format->getPossibleBitDepths().contains (bitsPerSample))
+            return { "can't write this format at " + juce::String (bitsPerSample) + " bits" };
+
+        job.destination.getParentDirectory().createDirectory();
+        juce::TemporaryFile temp (job.destination);
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+
+        if (auto stream = temp.getFile().createOutputStream())
+        {
+            writer.reset (format->createWriterFor (stream.get(), reader->sampleRate, (unsigned int) numChannels,
+                                                   bitsPerSample, reader->metadataValues, 0));
+
+            if (writer != nullptr)
+                stream.release();
+        }
+
+        if (writer == nullptr)
+            return { "can't create " + job.destination.getFullPathName() };
+
+        processor.setNonRealtime (true);
+        processor.setRateAndBufferSizeDetails (reader->sampleRate, blockSize);
+        processor.prepareToPlay (reader->sampleRate, blockSize);
+
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+        juce::MidiBuffer midi;
+
+        auto length = reader->lengthInSamples;
+        juce::int64 readPosition = 0, written = 0;
+        auto samplesToSkip = (juce::int64) processor.getLatencySamples();
+
+        // keep feeding silence past the end until the delayed output has caught up
+        while (written < length)
+        {
+            auto numToRead = (int) juce::jlimit ((juce::int64) 0, (juce::int64) blockSize, length - readPosition);
+
+            buffer.clear();
+
+            if (numToRead > 0 && ! reader->read (&buffer, 0, numToRead, readPosition, true, true))
+                return { "read error" };
+
+            readPosition += numToRead;
+            processor.processBlock (buffer, midi);
+
+            auto start = (int) juce::jmin ((juce::int64) blockSize, samplesToSkip);
+            auto numToWrite = (int) juce::jmin ((juce::int64) (blockSize - start), length - written);
+            samplesToSkip -= start;
+
+            if (numToWrite > 0 && ! writer->writeFromAudioSampleBuffer (buffer, start, numToWrite))
+                return { "write error" };
+
+            written += numToWrite;
+        }
+
+        processor.releaseResources();
+        writer.reset();
+
+        if (! temp.overwriteTargetFileWithTemporary())
+            return { "can't replace " + job.destination.getFullPathName() };
+
+        return { {}, (double) length / reader->sampleRate };
+    }
+
+    //==============================================================================
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker (int workerIndex, std::vector<std::unique_ptr<JobQueue>>& allQueues, const std::vector<Job>& allJobs,
+                std::vector<RenderResult>& allResults, LemonDriveAudioProcessor& processorToUse, int block,
+                juce::CriticalSection& outputLock)
+            : juce::Thread ("LemonDrive batch " + juce::String (workerIndex)),
+              index (workerIndex), queues (allQueues), jobs (allJobs), results (allResults),
+              processor (processorToUse), blockSize (block), printLock (outputLock)
+        {
+            formats.registerBasicFormats();
+        }
+
+        void run() override
+        {
+            int job;
+
+            while (! threadShouldExit() && (queues[(size_t) index]->popFront (job) || steal (job)))
+            {
+                auto start = juce::Time::getMillisecondCounterHiRes();
+                auto result = renderFile (processor, formats, jobs[(size_t) job], blockSize);
+                auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+                results[(size_t) job] = result;
+
+                const juce::ScopedLock sl (printLock);
+
+                if (result.error.isNotEmpty())
+                    std::cerr << "FAIL " << jobs[(size_t) job].source.getFullPathName() << ": " << result.error << std::endl;
+                else
+                    std::cerr << jobs[(size_t) job].source.getFileName() << "  "
+                              << juce::String (result.audioSeconds / juce::jmax (seconds, 1.0e-6), 1) << "x realtime" << std::endl;
+            }
+        }
+
+    private:
+        bool steal (int& job)
+        {
+            for (size_t i = 1; i < queues.size(); ++i)
+                if (queues[((size_t) index + i) % queues.size()]->stealBack (job))
+                    return true;
+
+            return false;
+        }
+
+        int index;
+        std::vector<std::unique_ptr<JobQueue>>& queues;
+        const std::vector<Job>& jobs;
+        std::vector<RenderResult>& results;
+        LemonDriveAudioProcessor& processor;
+        juce::AudioFormatManager formats;
+        int blockSize;
+        juce::CriticalSection& printLock;
+    };
+
+    //==============================================================================
+    bool applySettings (LemonDriveAudioProcessor& processor, const juce::String& preset, const juce::MemoryBlock& state)
+    {
+        if (! state.isEmpty())
+            processor.setStateInformation (state.getData(), (int) state.getSize());
+
+        if (preset.isEmpty())
+            return true;
+
+        for (int i = 0; i < processor.getNumPrograms(); ++i)
+        {
+            if (processor.getProgramName (i).equalsIgnoreCase (preset)
+                 || (preset.containsOnly ("0123456789") && preset.getIntValue() == i))
+            {
+                processor.setCurrentProgram (i);
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args (argc, argv);
+
+    if (! args.containsOption ("--input") || ! args.containsOption ("--output"))
+    {
+        std::cerr << "usage: LemonDriveBatch --input=dir --output=dir [--preset=name|index] [--state=file]"
+                     " [--threads=n] [--block=samples] [--recursive]" << std::endl;
+        return 1;
+    }
+
+    auto inputDir = args.getExistingFolderForOption ("--input");
+    auto outputDir = args.getFileForOption ("--output");
+    auto preset = args.getValueForOption ("--preset");
+    auto numThreads = args.containsOption ("--threads") ? args.getValueForOption ("--threads").getIntValue()
+                                                        : juce::SystemStats::getNumCpus();
+    auto blockSize = args.containsOption ("--block") ? args.getValueForOption ("--block").getIntValue() : 4096;
+
+    numThreads = juce::jmax (1, numThreads);
+    blockSize = juce::jlimit (32, 65536, blockSize);
+
+    juce::MemoryBlock state;
+
+    if (args.containsOption ("--state") && ! args.getExistingFileForOption ("--state").loadFileAsData (state))
+    {
+        std::cerr << "can't read state file" << std::endl;
+        return 1;
+    }
+
+    std::vector<Job> jobs;
+
+    for (auto& entry : juce::RangedDirectoryIterator (inputDir, args.containsOption ("--recursive"),
+                                                      "*.wav;*.wave;*.aif;*.aiff;*.flac", juce::File::findFiles))
+    {
+        auto& file = entry.getFile();
+        jobs.push_back ({ file, outputDir.getChildFile (file.getRelativePathFrom (inputDir)), entry.getFileSize() });
+    }
+
+    if (jobs.empty())
+    {
+        std::cerr << "no audio files in " << inputDir.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    // biggest first: owners start on the long files and thieves pick up the short ones at the back
+    std::sort (jobs.begin(), jobs.end(), [] (const Job& a, const Job& b) { return a.size > b.size; });
+    numThreads = juce::jmin (numThreads, (int) jobs.size());
+
+    // processors are built and configured here on the message thread, then only rendered with
+    std::vector<std::unique_ptr<LemonDriveAudioProcessor>> processors;
+    std::vector<std::unique_ptr<JobQueue>> queues;
+
+    for (int i = 0; i < numThreads; ++i)
+    {
+        processors.push_back (std::make_unique<LemonDriveAudioProcessor>());
+
+        if (! applySettings (*processors.back(), preset, state))
+        {
+            std::cerr << "no preset called " << preset << std::endl;
+            return 1;
+        }
+
+        queues.push_back (std::make_unique<JobQueue>());
+    }
+
+    for (size_t i = 0; i < jobs.size(); ++i)
+        queues[i % queues.size()]->push ((int) i);
+
+    std::vector<RenderResult> results (jobs.size());
+    juce::CriticalSection printLock;
+    juce::OwnedArray<Worker> workers;
+    auto start = juce::Time::getMillisecondCounterHiRes();
+
+    for (int i = 0; i < numThreads; ++i)
+        workers.add (new Worker (i, queues, jobs, results, *processors[(size_t) i], blockSize, printLock))->startThread();
+
+    for (auto* worker : workers)
+        worker->waitForThreadToExit (-1);
+
+    auto wallSeconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+    double audioSeconds = 0.0;
+    int failures = 0;
+
+    for (auto& result : results)
+    {
+        audioSeconds += result.audioSeconds;
+        failures += result.error.isNotEmpty() ? 1 : 0;
+    }
+
+    std::cout << jobs.size() - (size_t) failures << " files, " << juce::String (audioSeconds, 1) << " s of audio in "
+              << juce::String (wallSeconds, 2) << " s on " << numThreads << " threads: "
+              << juce::String (audioSeconds / juce::jmax (wallSeconds, 1.0e-6), 1) << "x realtime" << std::endl;
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,401 @@
+/*
+  ==============================================================================
+
+    Headless benchmark for LemonDriveAudioProcessor.
+
+    Drives prepareToPlay/processBlock directly with synthetic signals and
+    writes one JSON record per configuration:
+
+      LemonDriveBenchmark [--scenarios=default,hot,...] [--signals=sweep,noise,silence,decay]
+                          [--blocks=16,32,...,16384] [--rates=44100,48000,...]
+                          [--channels=1,2,6,12] [--seconds=0.5] [--output=results.json]
+                          [--baseline=previous.json] [--max-regression=10]
+                          [--max-allocs=0] [--max-p99-load=0.5] [--check]
+
+    The process exits with 1 if any configuration regresses by more than
+    --max-regression percent (ns/sample) against --baseline, allocates more
+    than --max-allocs times per block, or has a p99 block time above
+    --max-p99-load of its realtime deadline. --check first runs the kernel
+    checks below and fails the same way if any of them does.
+
+    The diode* scenarios run the circuit-modelled drive; compare its cost with
+    the atan shapers with
+
+      LemonDriveBenchmark --scenarios=default,reference,diode,diode-table,hot,diode-hot
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/Core/DriveShaper.h"
+#include <iostream>
+
+//==============================================================================
+// Allocations are only counted while a timed processBlock call is running.
+static std::atomic<bool> countAllocations { false };
+static std::atomic<juce::int64> allocationCount { 0 };
+
+static inline void noteAllocation() noexcept
+{
+    if (countAllocations.load (std::memory_order_relaxed))
+        allocationCount.fetch_add (1, std::memory_order_relaxed);
+}
+
+#if JUCE_LINUX
+// glibc lets the executable interpose malloc, which also catches JUCE's HeapBlock
+// and anything else that bypasses operator new.
+extern "C" void* __libc_malloc (size_t);
+extern "C" void* __libc_calloc (size_t, size_t);
+extern "C" void* __libc_realloc (void*, size_t);
+
+extern "C" void* malloc (size_t size)                   { noteAllocation(); return __libc_malloc (size); }
+extern "C" void* calloc (size_t num, size_t size)       { noteAllocation(); return __libc_calloc (num, size); }
+extern "C" void* realloc (void* ptr, size_t size)       { noteAllocation(); return __libc_realloc (ptr, size); }
+#else
+void* operator new (std::size_t size)
+{
+    noteAllocation();
+
+    if (auto* p = std::malloc (size == 0 ? 1 : size))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete (void* p) noexcept                 { std::free (p); }
+void operator delete (void* p, std::size_t) noexcept    { std::free (p); }
+#endif
+
+//==============================================================================
+namespace
+{
+    struct Scenario
+    {
+        juce::String name;
+        std::vector<std::pair<juce::String, float>> parameters;
+        bool automateDrive = false;
+        bool doublePrecision = false;
+    };
+
+    const std::vector<Scenario>& getScenarios()
+    {
+        static const std::vector<Scenario> scenarios
+        {
+            { "default",    {} },
+            { "hot",        { { "DRIVE", 0.0f }, { "RANGE", 4.0f }, { "CURVE", 0.9f } } },
+            { "reference",  { { "SHAPER", 1.0f } } },
+            { "table",      { { "SHAPER", 2.0f } } },
+            { "adaa2",      { { "ADAA", 2.0f } } },
+            { "diode",      { { "SHAPER", 3.0f } } },
+            { "diode-table", { { "SHAPER", 4.0f } } },
+            { "diode-hot",  { { "SHAPER", 3.0f }, { "DRIVE", 0.0f }, { "RANGE", 4.0f }, { "CURVE", 0.9f } } },
+            { "diode-os4x", { { "SHAPER", 4.0f }, { "OVERSAMPLING", 2.0f } } },
+            { "dynamics",   { { "DYNSOURCE", 1.0f }, { "DYNCUT", 2.0f } } },
+            { "os4x-iir",   { { "OVERSAMPLING", 2.0f } } },
+            { "os4x-fir",   { { "OVERSAMPLING", 2.0f }, { "OSFILTER", 1.0f } } },
+            { "automation", { { "SMOOTHING", 1.0f } }, true },
+            { "linked",     { { "LINK", 1.0f }, { "DRIVE", -6.0f } } },
+            { "chain",      { { "HIGHCUT", 8000.0f }, { "TILT", 6.0f } } },
+            { "linear-phase", { { "CUTMODE", 1.0f }, { "HIGHCUT", 8000.0f } } },
+            { "multiband",  { { "BANDS", 3.0f } } },
+            { "multiband-clean", { { "BANDS", 3.0f }, { "DRIVE1", -50.0f }, { "DRIVE2", -50.0f },
+                                   { "DRIVE3", -50.0f }, { "DRIVE4", -50.0f } } },
+            { "double",     {}, false, true },
+            { "double-os4x", { { "OVERSAMPLING", 2.0f } }, false, true }
+        };
+
+        return scenarios;
+    }
+
+    const juce::StringArray signalNames { "sweep", "noise", "silence", "decay" };
+
+    void fillSignal (juce::AudioBuffer<float>& buffer, const juce::String& signal, double sampleRate)
+    {
+        auto numSamples = buffer.getNumSamples();
+        juce::Random random (0x1e30);
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            auto* data = buffer.getWritePointer (channel);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto t = (double) i / sampleRate;
+
+                if (signal == "sweep")
+                {
+                    // exponential 20 Hz -> 20 kHz sweep over the whole buffer
+                    const double f0 = 20.0, f1 = 20000.0, length = (double) numSamples / sampleRate;
+                    auto k = std::log (f1 / f0);
+                    auto phase = juce::MathConstants<double>::twoPi * f0 * length / k * (std::exp (t / length * k) - 1.0);
+                    data[i] = 0.8f * (float) std::sin (phase);
+                }
+                else if (signal == "noise")
+                {
+                    data[i] = random.nextFloat() - 0.5f;
+                }
+                else if (signal == "decay")
+                {
+                    // 100 Hz tone decaying from 0.9 down to ~1e-42, well into the denormal range
+                    auto envelope = 0.9 * std::exp (std::log (1.0e-42) * (double) i / (double) numSamples);
+                    data[i] = (float) (envelope * std::sin (juce::MathConstants<double>::twoPi * 100.0 * t));
+                }
+                else
+                {
+                    data[i] = 0.0f;
+                }
+            }
+        }
+    }
+
+    void setParameter (LemonDriveAudioProcessor& processor, const juce::String& id, float value)
+    {
+        if (auto* param = processor.apvts.getParameter (id))
+            param->setValueNotifyingHost (param->convertTo0to1 (value));
+    }
+
+    juce::Array<int> parseIntList (const juce::String& text, const juce::Array<int>& defaults)
+    {
+        if (text.isEmpty())
+            return defaults;
+
+        juce::Array<int> values;
+
+        for (auto& token : juce::StringArray::fromTokens (text, ",", {}))
+            values.add (token.getIntValue());
+
+        return values;
+    }
+
+    juce::String getKey (const juce::var& result)
+    {
+        return result["scenario"].toString() + "/" + result["signal"].toString() + "/"
+             + result["sampleRate"].toString() + "/" + result["blockSize"].toString() + "/"
+             + result["channels"].toString();
+    }
+
+    //==============================================================================
+    /** Second-order ADAA has to be continuous where x[n] ~ x[n-2] switches it to its fallback:
+        alternating input that lands exactly on the fallback must match the general formula
+        just outside its tolerance.
+    */
+    int checkAdaa2Fallback()
+    {
+        int failures = 0;
+
+        for (auto amplitude : { 0.05, 0.5, 3.0, 40.0 })
+        {
+            auto run = [amplitude] (double offset)
+            {
+                lemondrive::DriveShaper::AdaaState state;
+                double data[8];
+
+                for (int i = 0; i < 8; ++i)
+                    data[i] = (i % 2 == 0 ? amplitude : -amplitude);
+
+                data[7] += offset;
+                lemondrive::DriveShaper::processAdaa2 (data, 8, 1.0, 1.0, state);
+                return data[7];
+            };
+
+            auto degenerate = run (0.0);
+            auto general = run (4.0 * lemondrive::DriveShaper::adaaTolerance);
+
+            if (std::abs (degenerate - general) > 1.0e-4)
+            {
+                ++failures;
+                std::cerr << "FAIL adaa2 fallback at +-" << amplitude << ": " << degenerate
+                          << " against " << general << std::endl;
+            }
+        }
+
+        return failures;
+    }
+
+    //==============================================================================
+    template <typename SampleType>
+    juce::var runConfiguration (const Scenario& scenario, const juce::String& signal,
+                                double sampleRate, int blockSize, int numChannels, double seconds)
+    {
+        LemonDriveAudioProcessor processor;
+
+        auto channelSet = juce::AudioChannelSet::canonicalChannelSet (numChannels);
+
+        if (channelSet.isDisabled())
+            channelSet = juce::AudioChannelSet::discreteChannels (numChannels);
+
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add (channelSet);
+        layout.inputBuses.add (juce::AudioChannelSet::disabled());   // sidechain
+        layout.outputBuses.add (channelSet);
+
+        if (! processor.setBusesLayout (layout))
+            return {};
+
+        for (auto& p : scenario.parameters)
+            setParameter (processor, p.first, p.second);
+
+        processor.setProcessingPrecision (std::is_same<SampleType, double>::value ? juce::AudioProcessor::doublePrecision
+                                                                                  : juce::AudioProcessor::singlePrecision);
+        processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        processor.prepareToPlay (sampleRate, blockSize);
+
+        auto numBlocks = juce::jmax (1, (int) (seconds * sampleRate) / blockSize);
+        juce::AudioBuffer<float> signalBuffer (numChannels, numBlocks * blockSize);
+        juce::AudioBuffer<SampleType> source, work (numChannels, blockSize);
+        juce::MidiBuffer midi;
+        fillSignal (signalBuffer, signal, sampleRate);
+        source.makeCopyOf (signalBuffer);
+
+        std::vector<double> blockTimes;
+        blockTimes.reserve ((size_t) numBlocks);
+
+        const auto ticksToNs = 1.0e9 / (double) juce::Time::getHighResolutionTicksPerSecond();
+        juce::int64 allocations = 0;
+        double totalNs = 0.0;
+
+        // the first pass warms up caches and tables and is not recorded
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    work.copyFrom (channel, 0, source, channel, block * blockSize, blockSize);
+
+                if (scenario.automateDrive)
+                    setParameter (processor, "DRIVE", -50.0f + 50.0f * (float) (block % 64) / 63.0f);
+
+                allocationCount = 0;
+                countAllocations = pass == 1;
+                auto start = juce::Time::getHighResolutionTicks();
+
+                processor.processBlock (work, midi);
+
+                auto end = juce::Time::getHighResolutionTicks();
+                countAllocations = false;
+
+                if (pass == 1)
+                {
+                    auto ns = (double) (end - start) * ticksToNs;
+                    blockTimes.push_back (ns);
+                    totalNs += ns;
+                    allocations += allocationCount.load();
+                }
+            }
+        }
+
+        processor.releaseResources();
+        std::sort (blockTimes.begin(), blockTimes.end());
+
+        auto percentile = [&blockTimes] (double p)
+        {
+            return blockTimes[(size_t) juce::jlimit (0, (int) blockTimes.size() - 1,
+                                                     (int) std::ceil (p * (double) blockTimes.size()) - 1)];
+        };
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty ("scenario", scenario.name);
+        result->setProperty ("precision", std::is_same<SampleType, double>::value ? "double" : "float");
+        result->setProperty ("signal", signal);
+        result->setProperty ("sampleRate", sampleRate);
+        result->setProperty ("blockSize", blockSize);
+        result->setProperty ("channels", numChannels);
+        result->setProperty ("blocks", numBlocks);
+        result->setProperty ("nsPerSample", totalNs / ((double) numBlocks * blockSize * numChannels));
+        result->setProperty ("p50BlockNs", percentile (0.50));
+        result->setProperty ("p99BlockNs", percentile (0.99));
+        result->setProperty ("maxBlockNs", blockTimes.back());
+        result->setProperty ("deadlineNs", 1.0e9 * blockSize / sampleRate);
+        result->setProperty ("allocationsPerBlock", (double) allocations / numBlocks);
+        return juce::var (result);
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args (argc, argv);
+
+    auto scenarioFilter = juce::StringArray::fromTokens (args.getValueForOption ("--scenarios"), ",", {});
+    auto signals = juce::StringArray::fromTokens (args.getValueForOption ("--signals"), ",", {});
+    auto blockSizes = parseIntList (args.getValueForOption ("--blocks"), { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384 });
+    auto sampleRates = parseIntList (args.getValueForOption ("--rates"), { 44100, 48000, 88200, 96000, 192000 });
+    auto channelCounts = parseIntList (args.getValueForOption ("--channels"), { 1, 2, 6, 12 });
+    auto seconds = args.containsOption ("--seconds") ? args.getValueForOption ("--seconds").getDoubleValue() : 0.5;
+    auto maxRegression = args.containsOption ("--max-regression") ? args.getValueForOption ("--max-regression").getDoubleValue() : -1.0;
+    auto maxAllocs = args.containsOption ("--max-allocs") ? args.getValueForOption ("--max-allocs").getDoubleValue() : -1.0;
+    auto maxP99Load = args.containsOption ("--max-p99-load") ? args.getValueForOption ("--max-p99-load").getDoubleValue() : -1.0;
+
+    if (signals.isEmpty())
+        signals = signalNames;
+
+    std::map<juce::String, double> baseline;
+
+    if (args.containsOption ("--baseline"))
+    {
+        auto baselineFile = args.getExistingFileForOption ("--baseline");
+        auto parsed = juce::JSON::parse (baselineFile);
+
+        if (auto* records = parsed.getArray())
+            for (auto& record : *records)
+                baseline[getKey (record)] = (double) record["nsPerSample"];
+    }
+
+    juce::Array<juce::var> results;
+    int failures = args.containsOption ("--check") ? checkAdaa2Fallback() : 0;
+
+    for (auto& scenario : getScenarios())
+    {
+        if (! scenarioFilter.isEmpty() && ! scenarioFilter.contains (scenario.name))
+            continue;
+
+        for (auto& signal : signals)
+            for (auto rate : sampleRates)
+                for (auto blockSize : blockSizes)
+                    for (auto numChannels : channelCounts)
+                    {
+                        auto result = scenario.doublePrecision ? runConfiguration<double> (scenario, signal, rate, blockSize, numChannels, seconds)
+                                                               : runConfiguration<float>  (scenario, signal, rate, blockSize, numChannels, seconds);
+
+                        if (result.isVoid())
+                        {
+                            std::cerr << "skipping unsupported layout: " << numChannels << " channels" << std::endl;
+                            continue;
+                        }
+
+                        juce::StringArray problems;
+                        auto nsPerSample = (double) result["nsPerSample"];
+                        auto it = baseline.find (getKey (result));
+
+                        if (maxRegression >= 0.0 && it != baseline.end() && nsPerSample > it->second * (1.0 + maxRegression / 100.0))
+                            problems.add ("regressed " + juce::String (100.0 * (nsPerSample / it->second - 1.0), 1) + "%");
+
+                        if (maxAllocs >= 0.0 && (double) result["allocationsPerBlock"] > maxAllocs)
+                            problems.add ("allocates " + result["allocationsPerBlock"].toString() + " times per block");
+
+                        if (maxP99Load >= 0.0 && (double) result["p99BlockNs"] > maxP99Load * (double) result["deadlineNs"])
+                            problems.add ("p99 block time over " + juce::String (maxP99Load * 100.0) + "% of deadline");
+
+                        if (! problems.isEmpty())
+                        {
+                            ++failures;
+                            result.getDynamicObject()->setProperty ("failures", problems.joinIntoString ("; "));
+                            std::cerr << "FAIL " << getKey (result) << ": " << problems.joinIntoString ("; ") << std::endl;
+                        }
+
+                        std::cerr << getKey (result) << "  " << juce::String (nsPerSample, 2) << " ns/sample" << std::endl;
+                        results.add (result);
+                    }
+    }
+
+    auto json = juce::JSON::toString (juce::var (results));
+
+    if (args.containsOption ("--output"))
+        args.getFileForOption ("--output").replaceWithText (json);
+    else
+        std::cout << json << std::endl;
+
+    return failures > 0 ? 1 : 0;
+}
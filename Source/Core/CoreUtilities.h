@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    CoreUtilities.h
+    Created: 22 Oct 2026 9:12:40am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+/*  The handful of juce_core pieces the DSP core needs, so that nothing under
+    Core/ includes JUCE. They behave like their JUCE namesakes.
+
+    Nothing in the core allocates: every per-channel array is sized for
+    LEMONDRIVE_MAX_CHANNELS up front, so the core can be embedded in a render
+    thread that must never touch the heap.
+*/
+#ifndef LEMONDRIVE_MAX_CHANNELS
+ #define LEMONDRIVE_MAX_CHANNELS 16
+#endif
+
+namespace lemondrive
+{
+    /** The most channels any core processor handles; extra channels are left untouched. */
+    constexpr int maxChannels = LEMONDRIVE_MAX_CHANNELS;
+
+    template <typename FloatType>
+    struct MathConstants
+    {
+        static constexpr FloatType pi     = static_cast<FloatType> (3.141592653589793238L);
+        static constexpr FloatType twoPi  = static_cast<FloatType> (2 * 3.141592653589793238L);
+        static constexpr FloatType halfPi = static_cast<FloatType> (3.141592653589793238L / 2);
+    };
+
+    struct Decibels
+    {
+        /** Like juce::Decibels::decibelsToGain(): anything at or below minusInfinityDb is silence. */
+        template <typename FloatType>
+        static FloatType decibelsToGain (FloatType decibels, FloatType minusInfinityDb = (FloatType) -100) noexcept
+        {
+            return decibels > minusInfinityDb ? std::pow ((FloatType) 10, decibels * (FloatType) 0.05) : FloatType();
+        }
+    };
+
+    template <typename Type>
+    constexpr Type limit (Type lowerLimit, Type upperLimit, Type value) noexcept
+    {
+        return value < lowerLimit ? lowerLimit : (upperLimit < value ? upperLimit : value);
+    }
+
+    //==============================================================================
+    enum class Smoothing
+    {
+        linear,
+        multiplicative
+    };
+
+    /** juce::SmoothedValue, same stepping and same skip() arithmetic, so the core and the
+        JUCE code it replaced produce the same ramps.
+    */
+    template <typename FloatType, Smoothing smoothing = Smoothing::linear>
+    class SmoothedValue
+    {
+    public:
+        void reset (double sampleRate, double rampLengthInSeconds) noexcept
+        {
+            stepsToTarget = (int) std::floor (rampLengthInSeconds * sampleRate);
+            setCurrentAndTargetValue (target);
+        }
+
+        void setCurrentAndTargetValue (FloatType newValue) noexcept
+        {
+            target = currentValue = newValue;
+            countdown = 0;
+        }
+
+        void setTargetValue (FloatType newValue) noexcept
+        {
+            if (newValue == target)
+                return;
+
+            if (stepsToTarget <= 0)
+            {
+                setCurrentAndTargetValue (newValue);
+                return;
+            }
+
+            target = newValue;
+            countdown = stepsToTarget;
+
+            if constexpr (smoothing == Smoothing::linear)
+                step = (target - currentValue) / (FloatType) countdown;
+            else
+                step = std::exp ((std::log (std::abs (target)) - std::log (std::abs (currentValue))) / (FloatType) countdown);
+        }
+
+        FloatType getNextValue() noexcept
+        {
+            if (! isSmoothing())
+                return target;
+
+            --countdown;
+
+            if (! isSmoothing())
+                currentValue = target;
+            else if constexpr (smoothing == Smoothing::linear)
+                currentValue += step;
+            else
+                currentValue *= step;
+
+            return currentValue;
+        }
+
+        FloatType skip (int numSamples) noexcept
+        {
+            if (numSamples >= countdown)
+            {
+                setCurrentAndTargetValue (target);
+                return target;
+            }
+
+            if constexpr (smoothing == Smoothing::linear)
+                currentValue += step * (FloatType) numSamples;
+            else
+                currentValue *= (FloatType) std::pow (step, numSamples);
+
+            countdown -= numSamples;
+            return currentValue;
+        }
+
+        bool isSmoothing() const noexcept           { return countdown > 0; }
+        FloatType getCurrentValue() const noexcept  { return currentValue; }
+        FloatType getTargetValue() const noexcept   { return target; }
+
+    private:
+        FloatType currentValue = 0, target = 0, step = 0;
+        int countdown = 0, stepsToTarget = 0;
+    };
+}
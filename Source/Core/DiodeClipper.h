@@ -0,0 +1,238 @@
+/*
+  ==============================================================================
+
+    DiodeClipper.h
+    Created: 24 Oct 2026 9:36:08am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "CoreUtilities.h"
+
+namespace lemondrive
+{
+/*  Circuit model of the drive stage: a resistor into a capacitor with a pair
+    of antiparallel diodes across it, the RC-loaded clipper of most overdrive
+    pedals. Unlike the atan curve it has memory and a corner frequency, so it
+    clips high frequencies earlier and rounds off transients.
+
+        C dV/dt = (Vin - V) / R - 2 Is sinh (V / (n Vt))
+
+    Discretised with the trapezoidal rule and written in u = V / (n Vt), every
+    sample leaves one implicit equation
+
+        a u + b sinh (u) = q,       a = 1 + T / 2RC,  b = T Is / (C n Vt)
+
+    where q is the trapezoidal state plus this sample's input. Its solution
+    only depends on q, so it is either found by Newton's method, warm-started
+    from the previous sample's u and capped at maxIterations, or read from a
+    DiodeTable of u (q) built for the rate.
+
+    Levels follow the atan kernels: an input of 1 is inputVolts across the
+    circuit and the output is V / inputVolts, so below the corner small
+    signals pass at unity and the same gains drive both models about as hard.
+*/
+struct DiodeCircuit
+{
+    /** 2.2k into 10 nF, a 7.2 kHz corner, and a pair of 1N4148s. */
+    static constexpr double resistance = 2.2e3;
+    static constexpr double capacitance = 10.0e-9;
+    static constexpr double saturationCurrent = 2.52e-9;
+    static constexpr double diodeVoltage = 1.752 * 25.85e-3;    // ideality factor times thermal voltage
+
+    /** Circuit volts for a kernel input of 1. */
+    static constexpr double inputVolts = 0.5;
+
+    /** T / 2RC */
+    static double getHalfStep (double sampleRate) noexcept     { return 1.0 / (2.0 * sampleRate * resistance * capacitance); }
+
+    /** a and b of the per-sample equation at this rate. */
+    static double getSlope (double sampleRate) noexcept        { return 1.0 + getHalfStep (sampleRate); }
+    static double getDiodeGain (double sampleRate) noexcept    { return saturationCurrent / (sampleRate * capacitance * diodeVoltage); }
+
+    /** Newton's method on a u + b sinh (u) = q from the guess u, safeguarded: the root has the sign
+        of q and |u| <= min (|q| / a, asinh (|q| / b)), every step narrows that bracket, and a step
+        that would leave it bisects instead. A poor guess costs iterations, never an overflow.
+    */
+    template <typename FloatType>
+    static FloatType solve (FloatType q, FloatType u, FloatType a, FloatType b, int iterations, FloatType tol) noexcept
+    {
+        const auto magnitude = std::abs (q);
+        auto lo = (FloatType) 0;
+        auto hi = std::min (magnitude / a, std::asinh (magnitude / b));
+        auto v = limit (lo, hi, q < 0 ? -u : u);
+
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            auto e = std::exp (v);
+            auto sinhV = (FloatType) 0.5 * (e - (FloatType) 1 / e);
+            auto coshV = (FloatType) 0.5 * (e + (FloatType) 1 / e);
+            auto g = a * v + b * sinhV - magnitude;
+
+            (g > 0 ? hi : lo) = v;
+
+            auto next = v - g / (a + b * coshV);
+
+            if (! (next >= lo && next <= hi))
+                next = (FloatType) 0.5 * (lo + hi);
+
+            auto step = next - v;
+            v = next;
+
+            if (std::abs (step) < tol)
+                break;
+        }
+
+        return q < 0 ? -v : v;
+    }
+};
+
+//==============================================================================
+/*  u (q) of the DiodeCircuit at one rate, for the table mode of DiodeClipper.
+
+    The solution is odd in q, so the table covers q >= 0, on a logarithmic grid
+    that is fine around the knee and coarse where u only grows logarithmically.
+    Every point is solved to convergence in double, which takes a few hundred
+    microseconds, so build tables off the audio thread. They never change
+    afterwards, and one table serves every clipper running at its rate.
+*/
+class DiodeTable
+{
+public:
+    static constexpr int size = 2048;
+
+    /** Inputs at or above this fall outside the table. */
+    static constexpr double maxInput = 2048.0;
+
+    explicit DiodeTable (double rate) noexcept
+        : sampleRate (rate)
+    {
+        const auto slope = DiodeCircuit::getSlope (sampleRate);
+        const auto diodeGain = DiodeCircuit::getDiodeGain (sampleRate);
+        const auto tMax = std::log1p (maxInput / scale);
+        resolution = (float) (size / tMax);
+
+        // each point starting from the one before
+        double u = 0.0;
+
+        for (int i = 0; i <= size; ++i)
+        {
+            auto q = scale * std::expm1 (tMax * (double) i / (double) size);
+            u = DiodeCircuit::solve (q, u, slope, diodeGain, 64, 1.0e-12);
+            values[i] = (float) u;
+        }
+    }
+
+    double getSampleRate() const noexcept   { return sampleRate; }
+
+    /** u for |q| < maxInput, interpolated linearly. */
+    template <typename FloatType>
+    FloatType lookup (FloatType q) const noexcept
+    {
+        auto position = std::log1p (std::abs (q) * (FloatType) (1.0 / scale)) * (FloatType) resolution;
+        auto index = std::min ((int) position, size - 1);
+        auto v = (FloatType) values[index] + (position - (FloatType) index) * (FloatType) (values[index + 1] - values[index]);
+
+        return q < 0 ? -v : v;
+    }
+
+private:
+    static constexpr double scale = 4.0;
+
+    double sampleRate;
+    float resolution = 0;
+    float values[size + 1];
+};
+
+//==============================================================================
+/*  The DiodeCircuit as a drive-stage kernel, with the history kept per channel
+    in a State. processTable() reads whichever table setTable() gave it, and
+    solves per sample like processNewton() whenever that table is missing, was
+    built for another rate, or the input runs past its range.
+*/
+template <typename SampleType>
+class DiodeClipper
+{
+public:
+    /** Newton iterations per sample at most; warm-started it rarely takes more than three. */
+    static constexpr int maxIterations = 8;
+
+    /** Per-channel history. */
+    struct State
+    {
+        SampleType s = 0;   // trapezoidal state, u + T/2 du/dt at the previous sample
+        SampleType u = 0;   // previous solution, where Newton starts
+
+        void reset() noexcept { *this = {}; }
+    };
+
+    /** The rate the circuit runs at, oversampling included. */
+    void setSampleRate (double sampleRate) noexcept
+    {
+        if (sampleRate == currentSampleRate)
+            return;
+
+        currentSampleRate = sampleRate;
+        slope = (SampleType) DiodeCircuit::getSlope (sampleRate);
+        diodeGain = (SampleType) DiodeCircuit::getDiodeGain (sampleRate);
+        inputGain = (SampleType) (DiodeCircuit::getHalfStep (sampleRate) * DiodeCircuit::inputVolts / DiodeCircuit::diodeVoltage);
+    }
+
+    double getSampleRate() const noexcept   { return currentSampleRate; }
+
+    /** The table for processTable(). Only the pointer is kept, so it has to outlive its use here. */
+    void setTable (const DiodeTable* newTable) noexcept     { table = newTable; }
+
+    /** data = outScale * clipper (inScale * data), solving every sample. */
+    void processNewton (SampleType* data, int numSamples, SampleType inScale, SampleType outScale, State& state) const noexcept
+    {
+        process (data, numSamples, inScale, outScale, state,
+                 [this] (SampleType q, SampleType u) { return DiodeCircuit::solve (q, u, slope, diodeGain, maxIterations, tolerance); });
+    }
+
+    /** The same as processNewton(), from the table where there is one for this rate. */
+    void processTable (SampleType* data, int numSamples, SampleType inScale, SampleType outScale, State& state) const noexcept
+    {
+        if (table == nullptr || table->getSampleRate() != currentSampleRate)
+        {
+            processNewton (data, numSamples, inScale, outScale, state);
+            return;
+        }
+
+        process (data, numSamples, inScale, outScale, state, [this] (SampleType q, SampleType u)
+        {
+            if (std::abs (q) >= (SampleType) DiodeTable::maxInput)
+                return DiodeCircuit::solve (q, u, slope, diodeGain, maxIterations, tolerance);
+
+            return table->lookup (q);
+        });
+    }
+
+private:
+    static constexpr SampleType tolerance = (SampleType) (sizeof (SampleType) > 4 ? 1.0e-9 : 1.0e-4);
+
+    template <typename Solver>
+    void process (SampleType* data, int numSamples, SampleType inScale, SampleType outScale, State& state, Solver&& solver) const noexcept
+    {
+        const auto in = inScale * inputGain;
+        const auto out = outScale * (SampleType) (DiodeCircuit::diodeVoltage / DiodeCircuit::inputVolts);
+        auto s = state.s, u = state.u;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            u = solver (s + in * data[i], u);
+            s = (SampleType) 2 * u - s;
+            data[i] = out * u;
+        }
+
+        state.s = s;
+        state.u = u;
+    }
+
+    double currentSampleRate = 0.0;
+    SampleType slope = 1, diodeGain = 0, inputGain = 0;
+    const DiodeTable* table = nullptr;
+};
+}
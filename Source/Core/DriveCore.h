@@ -0,0 +1,775 @@
+/*
+  ==============================================================================
+
+    DriveCore.h
+    Created: 22 Oct 2026 10:48:27am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "CoreUtilities.h"
+#include "DriveShaper.h"
+#include "DiodeClipper.h"
+#include "EnvelopeFollower.h"
+#include "LinkwitzRiley.h"
+#include "TiltFilter.h"
+#include "MultibandDrive.h"
+
+namespace lemondrive
+{
+/** Settings of the filter stages around the drive. */
+struct ChainSettings
+{
+    float lowCutFreq { 0 };
+    float highCutFreq { 0 };
+    float tiltDb { 0 };
+    MultibandSettings multiband;
+};
+
+/** The values the smoothed parameters head for, in parameter units (DRIVE in dB, TILT in dB,
+    cutoffs in Hz, the rest as plain gains).
+*/
+struct DriveTargets
+{
+    float drive = -20.0f;
+    float range = 1.0f;
+    float volume = 1.0f;
+    float lowCut = 20.0f;
+    float highCut = 20000.0f;
+    float curve = 0.5f;
+    float tilt = 0.0f;
+};
+
+//==============================================================================
+/*  The LOWCUT -> TILT -> drive -> TILT -> HIGHCUT -> VOLUME chain on raw channel
+    pointers, with no JUCE and no allocation anywhere, prepare() included.
+
+    The chain runs in three stages so a caller can put an oversampler around the
+    nonlinear one:
+
+      processPreDrive()   LOWCUT, emphasis and the dynamic drive at the host rate; fills the shaper gains
+      processDrive()      the shaper kernels, linked detector or multiband drive, at any rate
+      processPostDrive()  output gain, de-emphasis and HIGHCUT at the host rate
+
+    beginBlock() comes first in every host block. process() runs all three
+    stages at the host rate for callers that don't oversample. A render loop
+    without JUCE looks like
+
+        lemondrive::DriveCore<float> drive;
+        drive.prepare (48000.0, 2, targets);
+
+        // per block
+        drive.process (channels, 2, numSamples, targets, mode, multiband);
+
+    With dynamics enabled (setDynamics()), an envelope follower on the input or
+    on a detector signal from setDetector() moves DRIVE and LOWCUT every sample.
+
+    Up to maxChannels channels are processed; any beyond that are left as they are.
+*/
+template <typename SampleType>
+class DriveCore
+{
+public:
+    /** HIGHCUT at or above this is treated as off. */
+    static constexpr float highCutBypassFrequency = 20000.0f;
+
+    /** Output level (-120 dB) below which the chain counts as silent. */
+    static constexpr float silenceThreshold = 1.0e-6f;
+
+    enum class Shaper
+    {
+        fast,
+        reference,
+        adaaFirstOrder,
+        adaaSecondOrder,
+        diode,      // the DiodeClipper circuit, solved per sample
+        diodeTable, // the same circuit from its table of solutions
+        custom      // a kernel supplied to processDrive(), with CURVE and the 2/pi normalisation built in
+    };
+
+    /** How the drive stage runs for a block. */
+    struct DriveMode
+    {
+        Shaper shaper = Shaper::fast;
+        bool linked = false;            // one detector for all channels; ignored with ADAA and the diode, which need per-channel history
+        bool sampleAccurate = false;    // re-read the targets every sub-block instead of once per block
+        SampleType customSlope = 1;     // the custom kernel's slope at zero, for quiet linked samples
+    };
+
+    /** Shaper gains for one run of samples, filled by processPreDrive(). While nothing ramps the
+        kernels get the gains as inScale/outScale; otherwise the per-sample gains are applied
+        around the shaper and the kernels run at unity.
+    */
+    struct GainRamp
+    {
+        const SampleType* input = nullptr;
+        const SampleType* output = nullptr;
+        int numSamples = 0;
+        bool ramped = false;
+        SampleType inScale = 1, outScale = 1;
+    };
+
+    //==============================================================================
+    /** Roughly how long the filters ring after the input stops, until they are below silenceThreshold. */
+    static double getTailLengthSeconds (const ChainSettings& settings) noexcept
+    {
+        const auto decayTimeConstants = std::log (1.0 / (double) silenceThreshold);
+        const auto twoPi = MathConstants<double>::twoPi;
+
+        // LR4 = two Butterworth sections, whose envelope decays with a damping of 1/sqrt(2)
+        auto tail = decayTimeConstants * std::sqrt (2.0) / (twoPi * (double) settings.lowCutFreq);
+
+        if (settings.highCutFreq < highCutBypassFrequency)
+            tail += decayTimeConstants * std::sqrt (2.0) / (twoPi * (double) settings.highCutFreq);
+
+        // emphasis pole at the pivot, de-emphasis pole at pivot / ratio
+        if (settings.tiltDb != 0.0f)
+        {
+            auto ratio = Decibels::decibelsToGain ((double) settings.tiltDb);
+            tail += decayTimeConstants * (1.0 + ratio) / (twoPi * TiltFilter<SampleType>::pivotFrequency);
+        }
+
+        return tail + MultibandDrive<SampleType>::getTailLengthSeconds (settings.multiband, decayTimeConstants);
+    }
+
+    /** True if no sample of the first numChannels channels reaches the threshold. */
+    static bool isSilent (const SampleType* const* channels, int numChannels, int numSamples, SampleType threshold) noexcept
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                if (channels[channel][i] > threshold || channels[channel][i] < -threshold)
+                    return false;
+
+        return true;
+    }
+
+    DriveCore() noexcept
+    {
+        lowCut.setType (MultiChannelFilter<SampleType>::Type::highpass);
+        preEmphasis.setMode (TiltFilter<SampleType>::Mode::emphasis);
+        deEmphasis.setMode (TiltFilter<SampleType>::Mode::deEmphasis);
+        highCut.setType (MultiChannelFilter<SampleType>::Type::lowpass);
+    }
+
+    //==============================================================================
+    /** Sets the host rate and channel count and starts every smoother at its target. */
+    void prepare (double sampleRate, int numChannels, const DriveTargets& targets) noexcept
+    {
+        currentSampleRate = sampleRate;
+        preparedChannels = limit (0, maxChannels, numChannels);
+
+        lowCut.prepare (sampleRate, preparedChannels);
+        preEmphasis.prepare (sampleRate, preparedChannels);
+        deEmphasis.prepare (sampleRate, preparedChannels);
+        highCut.prepare (sampleRate, preparedChannels);
+        maxFilterFrequency = (float) (0.45 * sampleRate);
+        multiband.prepare (preparedChannels);
+        multibandActive = false;
+        follower.prepare (sampleRate, preparedChannels);
+        oversamplingFactor = 1;
+        diode.setSampleRate (sampleRate);
+        selectDiodeTable();
+
+        driveSmoothed.reset (sampleRate, smoothingTimeSeconds);
+        rangeSmoothed.reset (sampleRate, smoothingTimeSeconds);
+        curveSmoothed.reset (sampleRate, smoothingTimeSeconds);
+        volumeSmoothed.reset (sampleRate, smoothingTimeSeconds);
+        lowCutSmoothed.reset (sampleRate, smoothingTimeSeconds);
+        highCutSmoothed.reset (sampleRate, smoothingTimeSeconds);
+
+        driveSmoothed.setCurrentAndTargetValue ((SampleType) targets.drive);
+        rangeSmoothed.setCurrentAndTargetValue ((SampleType) targets.range);
+        curveSmoothed.setCurrentAndTargetValue ((SampleType) targets.curve);
+        volumeTarget = (SampleType) targets.volume;
+        volumeSmoothed.setCurrentAndTargetValue (std::max (volumeTarget, minimumSmoothedVolume));
+        lowCutSmoothed.setCurrentAndTargetValue ((SampleType) targets.lowCut);
+        highCutSmoothed.setCurrentAndTargetValue ((SampleType) targets.highCut);
+        lowCut.setCutoffFrequency (targets.lowCut);
+        highCut.setCutoffFrequency (std::min (targets.highCut, maxFilterFrequency));
+        updateTilt (targets.tilt);
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        lowCut.reset();
+        preEmphasis.reset();
+        deEmphasis.reset();
+        highCut.reset();
+        resetShaper();
+        multiband.reset();
+        follower.reset();
+    }
+
+    /** Clears the ADAA and diode history, which belongs to the rate it was recorded at. */
+    void resetShaper() noexcept
+    {
+        for (auto& state : adaaStates)
+            state.reset();
+
+        for (auto& state : diodeStates)
+            state.reset();
+    }
+
+    /** The drive stage runs at the host rate times this; a change clears the shaper history
+        and switches to the diode table for the new rate.
+    */
+    void setOversamplingFactor (int newFactor) noexcept
+    {
+        newFactor = std::max (1, newFactor);
+
+        if (newFactor != oversamplingFactor)
+        {
+            oversamplingFactor = newFactor;
+            diode.setSampleRate (currentSampleRate * (double) newFactor);
+            selectDiodeTable();
+            resetShaper();
+        }
+    }
+
+    /** Tables for Shaper::diodeTable, ideally one for every rate the drive stage may run at.
+        The core only keeps the pointers, and picks the one matching its rate whenever that
+        changes; at a rate without a table the diode is solved per sample instead.
+    */
+    void setDiodeTables (const DiodeTable* const* tables, int numTables) noexcept
+    {
+        numDiodeTables = limit (0, maxDiodeTables, numTables);
+        std::copy (tables, tables + numDiodeTables, diodeTables);
+        selectDiodeTable();
+    }
+
+    /** Leaves LOWCUT and HIGHCUT to the caller, e.g. linear-phase versions around the core.
+        The cutoffs keep gliding, so the filters come back at the right frequency, from clear state.
+    */
+    void setCutFiltersBypassed (bool shouldBypass) noexcept
+    {
+        if (cutFiltersBypassed && ! shouldBypass)
+        {
+            lowCut.reset();
+            highCut.reset();
+        }
+
+        cutFiltersBypassed = shouldBypass;
+    }
+
+    /** Switches the envelope modulation in or out and sets its times and depths, once per block.
+        The follower starts from silence whenever it is switched in.
+    */
+    void setDynamics (const DynamicsSettings& settings) noexcept
+    {
+        if (settings.enabled && ! dynamics.enabled)
+            follower.reset();
+
+        dynamics = settings;
+        follower.setTimes (settings.attackMs, settings.releaseMs);
+        dynamicDriveDepth = Decibels::decibelsToGain ((SampleType) settings.driveDb) - (SampleType) 1;
+        dynamicCutDepth = std::pow ((SampleType) 2, (SampleType) settings.cutOctaves) - (SampleType) 1;
+    }
+
+    /** The signal the envelope follows in the next processPreDrive() call, aligned with its
+        channels; channel c reads detector c % numChannels. Without it, or with no channels,
+        the follower listens to the input itself.
+    */
+    void setDetector (const SampleType* const* channels, int numChannels) noexcept
+    {
+        numDetectorChannels = limit (0, maxChannels, numChannels);
+
+        for (int channel = 0; channel < numDetectorChannels; ++channel)
+            detectorChannels[channel] = channels[channel];
+    }
+
+    /** Moves every smoother straight to its target, e.g. after the state was cleared while idle. */
+    void jumpToTargets (const DriveTargets& targets) noexcept
+    {
+        updateSmoothingTargets (targets);
+
+        driveSmoothed.setCurrentAndTargetValue (driveSmoothed.getTargetValue());
+        rangeSmoothed.setCurrentAndTargetValue (rangeSmoothed.getTargetValue());
+        curveSmoothed.setCurrentAndTargetValue (curveSmoothed.getTargetValue());
+        volumeSmoothed.setCurrentAndTargetValue (volumeSmoothed.getTargetValue());
+        lowCutSmoothed.setCurrentAndTargetValue (lowCutSmoothed.getTargetValue());
+        highCutSmoothed.setCurrentAndTargetValue (highCutSmoothed.getTargetValue());
+    }
+
+    /** Starts a host block: moves TILT, sets the smoothing targets and switches the multiband
+        drive in (numBands > 1) or out. The bands pick up RANGE and VOLUME from the targets.
+    */
+    void beginBlock (const DriveTargets& targets, const MultibandSettings& multibandSettings) noexcept
+    {
+        auto useMultiband = multibandSettings.numBands > 1;
+
+        if (useMultiband)
+        {
+            if (! multibandActive)
+                multiband.reset();
+
+            currentMultiband = multibandSettings;
+            currentMultiband.range = targets.range;
+            currentMultiband.volume = targets.volume;
+            multiband.setSampleRate (currentSampleRate * (double) oversamplingFactor);
+            multiband.setSettings (currentMultiband);
+        }
+
+        multibandActive = useMultiband;
+
+        // the emphasis pair changes together once per block, so both halves always match
+        updateTilt (targets.tilt);
+        updateSmoothingTargets (targets);
+        blockStarted = true;
+    }
+
+    //==============================================================================
+    /** LOWCUT, emphasis and the dynamic drive in place, and the shaper gains for the same samples written to
+        inputGains and outputGains (numSamples each, kept by the caller until processPostDrive()).
+        With a ramp, the input gains are already applied to the channels on return.
+
+        In sample-accurate mode nextTargets() is called for fresh targets at every sub-block
+        after the first one of the host block.
+    */
+    template <typename TargetSource>
+    GainRamp processPreDrive (SampleType* const* channels, int numChannels, int numSamples,
+                              SampleType* inputGains, SampleType* outputGains,
+                              const DriveMode& mode, TargetSource&& nextTargets) noexcept
+    {
+        numChannels = std::min (numChannels, preparedChannels);
+        auto forCustom = mode.shaper == Shaper::custom;
+        bool ramped = false;
+
+        // The run is only split while LOWCUT is gliding (the filter has no per-sample cutoff)
+        // or in sample-accurate mode, where the targets are re-read at every sub-block.
+        for (int start = 0; start < numSamples;)
+        {
+            if (mode.sampleAccurate && ! blockStarted)
+                updateSmoothingTargets (nextTargets());
+
+            blockStarted = false;
+
+            auto length = numSamples - start;
+
+            if (mode.sampleAccurate || lowCutSmoothed.isSmoothing())
+                length = std::min (length, automationSubBlockSize);
+
+            if (dynamics.enabled)
+                length = std::min (length, EnvelopeFollower<SampleType>::maxBlockSize);
+
+            lowCut.setCutoffFrequency ((float) lowCutSmoothed.getCurrentValue());
+            lowCutSmoothed.skip (length);
+
+            SampleType* subBlock[maxChannels];
+            offsetChannels (subBlock, channels, numChannels, start);
+
+            // the envelope is taken before LOWCUT, so the cut doesn't hide the lows it reacts to
+            if (dynamics.enabled)
+                followEnvelope (subBlock, numChannels, start, length, mode.linked);
+
+            if (! cutFiltersBypassed)
+            {
+                if (dynamics.enabled && dynamicCutDepth != (SampleType) 0)
+                    lowCut.processModulated (subBlock, numChannels, length, follower.getEnvelopes(), dynamicCutDepth);
+                else
+                    lowCut.process (subBlock, numChannels, length);
+            }
+
+            if (tiltActive)
+                preEmphasis.process (subBlock, numChannels, length);
+
+            if (dynamics.enabled && dynamicDriveDepth != (SampleType) 0)
+                applyDynamicDrive (subBlock, numChannels, length);
+
+            ramped = fillGainRamps (inputGains + start, outputGains + start, length, forCustom) || ramped;
+            start += length;
+        }
+
+        numDetectorChannels = 0;
+
+        // the bands glide their own gains; the single-band ramps only keep the smoothers moving
+        if (multibandActive)
+            ramped = false;
+
+        if (ramped)
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    channels[channel][i] *= inputGains[i];
+
+        GainRamp gains;
+        gains.input = inputGains;
+        gains.output = outputGains;
+        gains.numSamples = numSamples;
+        gains.ramped = ramped;
+        gains.inScale = ramped || numSamples == 0 ? (SampleType) 1 : inputGains[0];
+        gains.outScale = ramped || numSamples == 0 ? (SampleType) 1 : outputGains[0];
+        return gains;
+    }
+
+    /** The nonlinear stage in place, at whatever rate the channels are at. linkScratch needs room
+        for 2 * numSamples values when mode.linked is set; without it the channels run unlinked.
+        customKernel (data, numSamples, inScale, outScale) is only called for Shaper::custom.
+    */
+    template <typename CustomKernel>
+    void processDrive (SampleType* const* channels, int numChannels, int numSamples, const GainRamp& gains,
+                       const DriveMode& mode, SampleType* linkScratch, CustomKernel&& customKernel) noexcept
+    {
+        numChannels = std::min (numChannels, preparedChannels);
+
+        const auto inScale = gains.inScale;
+        const auto outScale = gains.outScale;
+
+        auto runShaper = [&] (SampleType* data, int channel)
+        {
+            switch (mode.shaper)
+            {
+                case Shaper::adaaFirstOrder:    DriveShaper::processAdaa1 (data, numSamples, inScale, outScale, adaaStates[channel]); break;
+                case Shaper::adaaSecondOrder:   DriveShaper::processAdaa2 (data, numSamples, inScale, outScale, adaaStates[channel]); break;
+                case Shaper::diode:             diode.processNewton (data, numSamples, inScale, outScale, diodeStates[channel]); break;
+                case Shaper::diodeTable:        diode.processTable (data, numSamples, inScale, outScale, diodeStates[channel]); break;
+                case Shaper::custom:            customKernel (data, numSamples, inScale, outScale); break;
+                case Shaper::reference:         DriveShaper::processReference (data, numSamples, inScale, outScale); break;
+                case Shaper::fast:
+                default:                        DriveShaper::processFast (data, numSamples, inScale, outScale); break;
+            }
+        };
+
+        // Multiband splits, drives and sums the bands in one pass. Linked: one detector (the loudest
+        // channel at each sample) goes through the shaper and its gain, f(d)/d, is applied to every channel.
+        if (multibandActive)
+        {
+            multiband.process (channels, numChannels, numSamples);
+        }
+        else if (isLinked (mode, numChannels) && linkScratch != nullptr)
+        {
+            auto* detector = linkScratch;
+            auto* linkGains = linkScratch + numSamples;
+
+            for (int i = 0; i < numSamples; ++i)
+                detector[i] = std::abs (channels[0][i]);
+
+            for (int channel = 1; channel < numChannels; ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    detector[i] = std::max (detector[i], std::abs (channels[channel][i]));
+
+            std::copy (detector, detector + numSamples, linkGains);
+            runShaper (linkGains, 0);
+
+            // below this the shaper is linear, so use its slope at zero
+            const auto slope = inScale * outScale * (mode.shaper == Shaper::custom ? mode.customSlope : (SampleType) 1);
+
+            for (int i = 0; i < numSamples; ++i)
+                linkGains[i] = detector[i] > (SampleType) 1.0e-6 ? linkGains[i] / detector[i] : slope;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    channels[channel][i] *= linkGains[i];
+        }
+        else
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                runShaper (channels[channel], channel);
+        }
+    }
+
+    void processDrive (SampleType* const* channels, int numChannels, int numSamples, const GainRamp& gains,
+                       const DriveMode& mode, SampleType* linkScratch) noexcept
+    {
+        processDrive (channels, numChannels, numSamples, gains, mode, linkScratch,
+                      [] (SampleType* data, int n, SampleType in, SampleType out) { DriveShaper::processFast (data, n, in, out); });
+    }
+
+    /** Output gain, de-emphasis and HIGHCUT in place, at the host rate. The output gain goes in
+        before the filters, so their state is always in the same (post-VOLUME) domain whether or
+        not this run was ramped.
+    */
+    void processPostDrive (SampleType* const* channels, int numChannels, const GainRamp& gains) noexcept
+    {
+        numChannels = std::min (numChannels, preparedChannels);
+        auto numSamples = gains.numSamples;
+
+        if (gains.ramped)
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    channels[channel][i] *= gains.output[i];
+
+        setHighCutActive (highCutSmoothed.isSmoothing() || highCutSmoothed.getTargetValue() < (SampleType) highCutBypassFrequency);
+
+        // split into sub-blocks only while HIGHCUT glides
+        for (int start = 0; start < numSamples;)
+        {
+            auto length = numSamples - start;
+
+            if (highCutSmoothed.isSmoothing())
+                length = std::min (length, automationSubBlockSize);
+
+            highCut.setCutoffFrequency (std::min ((float) highCutSmoothed.getCurrentValue(), maxFilterFrequency));
+            highCutSmoothed.skip (length);
+
+            SampleType* subBlock[maxChannels];
+            offsetChannels (subBlock, channels, numChannels, start);
+
+            if (tiltActive)
+                deEmphasis.process (subBlock, numChannels, length);
+
+            if (highCutActive && ! cutFiltersBypassed)
+                highCut.process (subBlock, numChannels, length);
+
+            start += length;
+        }
+    }
+
+    //==============================================================================
+    /** The whole chain at the host rate in one call, for callers without an oversampler.
+        Runs in chunks of the core's own gain buffers, so any block size works.
+    */
+    void process (SampleType* const* channels, int numChannels, int numSamples,
+                  const DriveTargets& targets, const DriveMode& mode, const MultibandSettings& multibandSettings) noexcept
+    {
+        setOversamplingFactor (1);
+        beginBlock (targets, multibandSettings);
+
+        auto nextTargets = [&targets] { return targets; };
+
+        for (int start = 0; start < numSamples; start += maxChunkSize)
+        {
+            auto length = std::min (maxChunkSize, numSamples - start);
+
+            SampleType* chunk[maxChannels];
+            offsetChannels (chunk, channels, std::min (numChannels, preparedChannels), start);
+
+            auto gains = processPreDrive (chunk, numChannels, length, chunkInputGains, chunkOutputGains, mode, nextTargets);
+            processDrive (chunk, numChannels, length, gains, mode, chunkLinkScratch);
+            processPostDrive (chunk, numChannels, gains);
+        }
+    }
+
+    //==============================================================================
+    /** The most a quiet input can be amplified by on its way through the chain, with the
+        smoothers either where they are or at the given targets.
+    */
+    SampleType getMaximumSmallSignalGain (const DriveTargets& targets) const noexcept
+    {
+        auto getGain = [] (SampleType drive, SampleType range, SampleType curve, SampleType volume)
+        {
+            return Decibels::decibelsToGain (drive) * range * (SampleType) 2 / ((SampleType) 1 - curve) * volume;
+        };
+
+        auto gain = std::max (getGain (driveSmoothed.getCurrentValue(), rangeSmoothed.getCurrentValue(),
+                                       curveSmoothed.getCurrentValue(), volumeSmoothed.getCurrentValue()),
+                              getGain ((SampleType) targets.drive, (SampleType) targets.range,
+                                       (SampleType) targets.curve, (SampleType) targets.volume));
+
+        if (multibandActive)
+            gain = std::max (gain, multiband.getSmallSignalGain());
+
+        // a full-scale envelope adds the whole dynamic drive
+        if (dynamics.enabled)
+            gain *= std::max ((SampleType) 1, (SampleType) 1 + dynamicDriveDepth);
+
+        return gain;
+    }
+
+    /** Small-signal gain of the drive stage at the end of a run, for the saturation meter. */
+    SampleType getSmallSignalGain (const GainRamp& gains, const DriveMode& mode) const noexcept
+    {
+        // the drive-input level is measured before the crossovers, which sum to unity gain
+        if (multibandActive)
+            return multiband.getSmallSignalGain();
+
+        auto last = gains.numSamples - 1;
+        auto lastGain = gains.ramped ? gains.input[last] * gains.output[last] : gains.inScale * gains.outScale;
+
+        // the custom kernel has pi/(1-curve) * 2/pi built in, the others get it through the gains
+        return lastGain * (mode.shaper == Shaper::custom ? (SampleType) 2 / ((SampleType) 1 - curveSmoothed.getCurrentValue())
+                                                         : (SampleType) 1);
+    }
+
+    /** Tail length at the current cutoffs, tilt and band layout, at the host rate. */
+    double getTailLengthSeconds() const noexcept
+    {
+        ChainSettings settings { lowCut.getCutoffFrequency(),
+                                 highCutActive ? highCut.getCutoffFrequency() : highCutBypassFrequency,
+                                 preEmphasis.getTilt() };
+
+        if (multibandActive)
+            settings.multiband = currentMultiband;
+
+        return getTailLengthSeconds (settings);
+    }
+
+    bool isMultibandActive() const noexcept     { return multibandActive; }
+    bool isLinked (const DriveMode& mode, int numChannels) const noexcept
+    {
+        // ADAA and the diode keep per-channel history, so they always run unlinked
+        return mode.linked && numChannels > 1 && mode.shaper != Shaper::adaaFirstOrder && mode.shaper != Shaper::adaaSecondOrder
+                && mode.shaper != Shaper::diode && mode.shaper != Shaper::diodeTable;
+    }
+
+private:
+    static void offsetChannels (SampleType** dest, SampleType* const* channels, int numChannels, int offset) noexcept
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            dest[channel] = channels[channel] + offset;
+    }
+
+    void followEnvelope (SampleType* const* subBlock, int numChannels, int start, int length, bool linked) noexcept
+    {
+        if (numDetectorChannels == 0)
+        {
+            follower.process (subBlock, numChannels, numChannels, length, linked);
+            return;
+        }
+
+        const SampleType* detectorBlock[maxChannels];
+
+        for (int channel = 0; channel < numDetectorChannels; ++channel)
+            detectorBlock[channel] = detectorChannels[channel] + start;
+
+        follower.process (detectorBlock, numDetectorChannels, numChannels, length, linked);
+    }
+
+    /** The drive gain follows the envelope linearly, from DRIVE when quiet to DRIVE plus the
+        dynamic drive at full scale. It goes in ahead of the shaper gains, like RANGE.
+    */
+    void applyDynamicDrive (SampleType* const* subBlock, int numChannels, int length) noexcept
+    {
+        auto* const* envelopes = follower.getEnvelopes();
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = subBlock[channel];
+            auto* envelope = envelopes[channel];
+
+            for (int i = 0; i < length; ++i)
+                data[i] *= (SampleType) 1 + dynamicDriveDepth * envelope[i];
+        }
+    }
+
+    void selectDiodeTable() noexcept
+    {
+        const DiodeTable* match = nullptr;
+
+        for (int i = 0; i < numDiodeTables; ++i)
+            if (diodeTables[i] != nullptr && diodeTables[i]->getSampleRate() == diode.getSampleRate())
+                match = diodeTables[i];
+
+        diode.setTable (match);
+    }
+
+    void updateTilt (float tiltDb) noexcept
+    {
+        preEmphasis.setTilt (tiltDb);
+        deEmphasis.setTilt (tiltDb);
+
+        // a stage coming out of bypass starts from clear state
+        if (tiltDb != 0.0f && ! tiltActive)
+        {
+            preEmphasis.reset();
+            deEmphasis.reset();
+        }
+
+        tiltActive = tiltDb != 0.0f;
+    }
+
+    void setHighCutActive (bool shouldBeActive) noexcept
+    {
+        if (shouldBeActive && ! highCutActive)
+            highCut.reset();
+
+        highCutActive = shouldBeActive;
+    }
+
+    // the smoothers ramp each value in its own domain (linear in dB for drive, multiplicative
+    // for gains and frequencies), so a moving morph is interpolated per sample the same way
+    void updateSmoothingTargets (const DriveTargets& targets) noexcept
+    {
+        driveSmoothed.setTargetValue ((SampleType) targets.drive);
+        rangeSmoothed.setTargetValue ((SampleType) targets.range);
+        curveSmoothed.setTargetValue ((SampleType) targets.curve);
+        lowCutSmoothed.setTargetValue ((SampleType) targets.lowCut);
+        highCutSmoothed.setTargetValue ((SampleType) targets.highCut);
+
+        volumeTarget = (SampleType) targets.volume;
+        volumeSmoothed.setTargetValue (std::max (volumeTarget, minimumSmoothedVolume));
+    }
+
+    /** Fills the shaper input and output gains for a run of samples; returns false if they are constant. */
+    bool fillGainRamps (SampleType* inputGains, SampleType* outputGains, int numSamples, bool forCustom) noexcept
+    {
+        const auto pi = MathConstants<SampleType>::pi;
+
+        // the custom kernel already contains pi/(1-curve) and the 2/pi normalisation
+        auto getInputGain = [forCustom, pi] (SampleType drive, SampleType range, SampleType curve)
+        {
+            return Decibels::decibelsToGain (drive) * range * (forCustom ? (SampleType) 1 : pi / ((SampleType) 1 - curve));
+        };
+
+        auto outputNormalisation = forCustom ? (SampleType) 1 : (SampleType) 2 / pi;
+
+        if (! (driveSmoothed.isSmoothing() || rangeSmoothed.isSmoothing()
+                || curveSmoothed.isSmoothing() || volumeSmoothed.isSmoothing()))
+        {
+            // a target of exactly 0 can't be reached multiplicatively, so snap to it once the ramp is done
+            auto volume = volumeTarget <= (SampleType) 0 ? (SampleType) 0 : volumeSmoothed.getCurrentValue();
+
+            std::fill (inputGains, inputGains + numSamples, getInputGain (driveSmoothed.getCurrentValue(),
+                                                                          rangeSmoothed.getCurrentValue(),
+                                                                          curveSmoothed.getCurrentValue()));
+            std::fill (outputGains, outputGains + numSamples, volume * outputNormalisation);
+            return false;
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto drive = driveSmoothed.getNextValue();
+            auto range = rangeSmoothed.getNextValue();
+            auto curve = curveSmoothed.getNextValue();
+
+            inputGains[i] = getInputGain (drive, range, curve);
+            outputGains[i] = volumeSmoothed.getNextValue() * outputNormalisation;
+        }
+
+        return true;
+    }
+
+    //==============================================================================
+    // DRIVE is smoothed in dB, VOLUME, LOWCUT and HIGHCUT multiplicatively
+    static constexpr double smoothingTimeSeconds = 0.02;
+    static constexpr SampleType minimumSmoothedVolume = (SampleType) 1.0e-5;
+    static constexpr int automationSubBlockSize = 32;
+    static constexpr int maxChunkSize = 256;
+
+    double currentSampleRate = 44100.0;
+    int preparedChannels = 0;
+    int oversamplingFactor = 1;
+
+    MultiChannelFilter<SampleType> lowCut, highCut;
+    TiltFilter<SampleType> preEmphasis, deEmphasis;
+    bool tiltActive = false, highCutActive = false, blockStarted = false, cutFiltersBypassed = false;
+    float maxFilterFrequency = 20000.0f;
+
+    DriveShaper::AdaaState adaaStates[maxChannels];
+    DiodeClipper<SampleType> diode;
+    typename DiodeClipper<SampleType>::State diodeStates[maxChannels];
+
+    static constexpr int maxDiodeTables = 8;
+    const DiodeTable* diodeTables[maxDiodeTables] {};
+    int numDiodeTables = 0;
+
+    MultibandDrive<SampleType> multiband;
+    MultibandSettings currentMultiband;
+    bool multibandActive = false;
+
+    EnvelopeFollower<SampleType> follower;
+    DynamicsSettings dynamics;
+    SampleType dynamicDriveDepth = 0, dynamicCutDepth = 0;
+    const SampleType* detectorChannels[maxChannels] {};
+    int numDetectorChannels = 0;
+
+    SmoothedValue<SampleType> driveSmoothed, rangeSmoothed, curveSmoothed;
+    SmoothedValue<SampleType, Smoothing::multiplicative> volumeSmoothed, lowCutSmoothed, highCutSmoothed;
+    SampleType volumeTarget = 0;
+
+    // process() only
+    SampleType chunkInputGains[maxChunkSize], chunkOutputGains[maxChunkSize], chunkLinkScratch[2 * maxChunkSize];
+};
+}
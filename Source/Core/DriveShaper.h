@@ -0,0 +1,204 @@
+/*
+  ==============================================================================
+
+    DriveShaper.h
+    Created: 17 Oct 2026 10:04:12am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "CoreUtilities.h"
+#include "Simd.h"
+
+/*  Waveshaper kernels for the drive stage.
+
+    The drive stage computes  y = outScale * atan (inScale * x), where the
+    processor folds DRIVE/RANGE/CURVE into inScale and VOLUME (and the 2/pi
+    normalisation) into outScale once per block.
+
+    The "fast" kernel uses a minimax polynomial for atan on [-1, 1] together
+    with the identity atan (x) = sign (x) * pi/2 - atan (1/x) for |x| > 1.
+    Measured against std::atan its absolute error is below 2e-6 rad, i.e. the
+    shaper output differs from the reference by less than 1.3e-6 (about -118 dB).
+
+    The ADAA kernels replace atan (u) by the divided difference of its first or
+    second antiderivative, which suppresses aliasing at a fraction of the cost
+    of oversampling. They are evaluated in double because the divided
+    differences cancel badly in float once u gets large.
+
+    Every kernel is templated on the sample type so the float and double
+    processing paths share one implementation. The fast kernel keeps its
+    polynomial (and so its error bound) in double; use the reference kernel
+    when the double path has to be exact.
+*/
+namespace lemondrive::DriveShaper
+{
+    /** Maximum absolute difference between fastAtan() and std::atan(). */
+    constexpr float fastAtanMaxError = 2.0e-6f;
+
+    /** Odd minimax polynomial for atan on [-1, 1]. Works for scalars and SIMD registers. */
+    template <typename T>
+    inline T atanPoly (T z) noexcept
+    {
+        auto z2 = z * z;
+        return (((((z2 * -0.01172120f + 0.05265332f) * z2 - 0.11643287f) * z2
+                    + 0.19354346f) * z2 - 0.33262347f) * z2 + 0.99997726f) * z;
+    }
+
+    template <typename FloatType>
+    inline FloatType fastAtan (FloatType x) noexcept
+    {
+        auto ax = std::abs (x);
+        auto c  = limit ((FloatType) -1, (FloatType) 1, x);
+        auto p  = atanPoly (c / std::max (ax, (FloatType) 1));
+
+        return ax > (FloatType) 1 ? c * MathConstants<FloatType>::halfPi - p : p;
+    }
+
+   #if LEMONDRIVE_USE_SIMD
+    template <typename FloatType>
+    using Vec = SimdRegister<FloatType>;
+
+    /** Branch-free vector version of fastAtan(). Four floats or two doubles per SSE/NEON register. */
+    template <typename FloatType>
+    inline Vec<FloatType> fastAtan (Vec<FloatType> x) noexcept
+    {
+        const auto one      = Vec<FloatType>::expand ((FloatType) 1);
+        const auto minusOne = Vec<FloatType>::expand ((FloatType) -1);
+
+        auto ax = Vec<FloatType>::max (x, Vec<FloatType>::expand ((FloatType) 0) - x);
+        auto c  = Vec<FloatType>::min (Vec<FloatType>::max (x, minusOne), one);
+        auto p  = atanPoly (c / Vec<FloatType>::max (ax, one));
+
+        // for |x| > 1: sign (x) * pi/2 - p, otherwise p
+        auto correction = c * MathConstants<FloatType>::halfPi - p * (FloatType) 2;
+        return p + (correction & Vec<FloatType>::greaterThan (ax, one));
+    }
+   #endif
+
+    //==============================================================================
+    /** Exact shaper using std::atan, kept as the reference for the fast kernel. */
+    template <typename FloatType>
+    inline void processReference (FloatType* data, int numSamples, FloatType inScale, FloatType outScale) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = outScale * std::atan (inScale * data[i]);
+    }
+
+    /** Vectorised shaper: scalar head up to SIMD alignment, SIMD body, scalar tail. */
+    template <typename FloatType>
+    inline void processFast (FloatType* data, int numSamples, FloatType inScale, FloatType outScale) noexcept
+    {
+        auto* end = data + numSamples;
+
+       #if LEMONDRIVE_USE_SIMD
+        using V = Vec<FloatType>;
+        auto* aligned = std::min (V::getNextSIMDAlignedPtr (data), end);
+
+        for (; data < aligned; ++data)
+            *data = outScale * fastAtan (inScale * *data);
+
+        const auto inV  = V::expand (inScale);
+        const auto outV = V::expand (outScale);
+        auto numVectors = (end - data) / (std::ptrdiff_t) V::size();
+
+        for (; numVectors > 0; --numVectors, data += V::size())
+            (outV * fastAtan (V::fromRawArray (data) * inV)).copyToRawArray (data);
+       #endif
+
+        for (; data < end; ++data)
+            *data = outScale * fastAtan (inScale * *data);
+    }
+
+    //==============================================================================
+    /** Per-channel history for the ADAA kernels, in the pre-scaled (u = inScale * x) domain. */
+    struct AdaaState
+    {
+        double x1 = 0.0;    // u[n-1]
+        double x2 = 0.0;    // u[n-2]
+        double d2 = 0.0;    // previous first divided difference of atanAD2 (second order only)
+
+        void reset() noexcept { *this = {}; }
+    };
+
+    /** Below this |u[n] - u[n-1]| the divided differences are replaced by their limits. */
+    constexpr double adaaTolerance = 1.0e-5;
+
+    /** First antiderivative of atan. */
+    inline double atanAD1 (double u) noexcept
+    {
+        return u * std::atan (u) - 0.5 * std::log1p (u * u);
+    }
+
+    /** Second antiderivative of atan. */
+    inline double atanAD2 (double u) noexcept
+    {
+        return 0.5 * ((u * u - 1.0) * std::atan (u) + u - u * std::log1p (u * u));
+    }
+
+    template <typename FloatType>
+    inline void processAdaa1 (FloatType* data, int numSamples, FloatType inScale, FloatType outScale, AdaaState& state) noexcept
+    {
+        auto x1 = state.x1;
+        auto ad1x1 = atanAD1 (x1);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto x = (double) inScale * data[i];
+            auto ad1x = atanAD1 (x);
+            auto delta = x - x1;
+
+            auto y = std::abs (delta) < adaaTolerance ? std::atan (0.5 * (x + x1))
+                                                      : (ad1x - ad1x1) / delta;
+
+            data[i] = outScale * (FloatType) y;
+            x1 = x;
+            ad1x1 = ad1x;
+        }
+
+        state.x1 = x1;
+    }
+
+    template <typename FloatType>
+    inline void processAdaa2 (FloatType* data, int numSamples, FloatType inScale, FloatType outScale, AdaaState& state) noexcept
+    {
+        auto x1 = state.x1, x2 = state.x2, d2 = state.d2;
+        auto ad2x1 = atanAD2 (x1);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto x = (double) inScale * data[i];
+            auto ad2x = atanAD2 (x);
+
+            auto d1 = std::abs (x - x1) < adaaTolerance ? atanAD1 (0.5 * (x + x1))
+                                                        : (ad2x - ad2x1) / (x - x1);
+            double y;
+
+            if (std::abs (x - x2) < adaaTolerance)
+            {
+                // x[n] ~ x[n-2]: replace both by their midpoint and expand around x[n-1]
+                auto xBar = 0.5 * (x + x2);
+                auto delta = xBar - x1;
+
+                y = std::abs (delta) < adaaTolerance ? std::atan (0.5 * (xBar + x1))
+                                                     : (2.0 / delta) * (atanAD1 (xBar) + (ad2x1 - atanAD2 (xBar)) / delta);
+            }
+            else
+            {
+                y = (2.0 / (x - x2)) * (d1 - d2);
+            }
+
+            data[i] = outScale * (FloatType) y;
+            d2 = d1;
+            x2 = x1;
+            x1 = x;
+            ad2x1 = ad2x;
+        }
+
+        state.x1 = x1;
+        state.x2 = x2;
+        state.d2 = d2;
+    }
+}
@@ -0,0 +1,216 @@
+/*
+  ==============================================================================
+
+    EnvelopeFollower.h
+    Created: 25 Oct 2026 10:12:54am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "CoreUtilities.h"
+#include "Simd.h"
+
+namespace lemondrive
+{
+/** How the input or sidechain envelope moves DRIVE and LOWCUT. */
+struct DynamicsSettings
+{
+    bool enabled = false;
+    float attackMs = 5.0f;
+    float releaseMs = 150.0f;
+    float driveDb = 12.0f;      // extra drive at a full-scale envelope
+    float cutOctaves = 1.0f;    // how far LOWCUT rises at a full-scale envelope
+};
+
+//==============================================================================
+/*  Peak envelope follower with separate attack and release, for up to
+    maxChannels channels at once.
+
+    The recursion runs along time, so it is vectorised across channels instead:
+    each group of SIMD-width channels is interleaved into the lanes of one
+    register and followed in a single pass, the attack or release coefficient
+    picked per lane with a compare mask. Mono runs the scalar version in place.
+
+    The envelope is clamped to 1 (full scale) on output, so it can be used as a
+    modulation amount directly. Blocks are at most maxBlockSize samples; the
+    envelopes of the last block stay readable until the next one.
+*/
+template <typename SampleType>
+class EnvelopeFollower
+{
+public:
+   #if LEMONDRIVE_USE_SIMD
+    using Vec = SimdRegister<SampleType>;
+   #else
+    using Vec = SampleType;
+   #endif
+
+    static constexpr size_t lanes = sizeof (Vec) / sizeof (SampleType);
+    static constexpr int maxBlockSize = 128;
+
+    EnvelopeFollower() noexcept
+    {
+        for (int channel = 0; channel < maxChannels; ++channel)
+            envelopePointers[channel] = envelopes[channel];
+    }
+
+    void prepare (double newSampleRate, int numChannels) noexcept
+    {
+        sampleRate = newSampleRate;
+        preparedChannels = limit (0, maxChannels, numChannels);
+        attackMs = releaseMs = -1.0f;
+        setTimes (5.0f, 150.0f);
+        reset();
+    }
+
+    /** Recomputes the coefficients only if a time actually moved. */
+    void setTimes (float newAttackMs, float newReleaseMs) noexcept
+    {
+        if (newAttackMs == attackMs && newReleaseMs == releaseMs)
+            return;
+
+        attackMs = newAttackMs;
+        releaseMs = newReleaseMs;
+
+        auto coefficient = [this] (float ms) { return (SampleType) std::exp (-1000.0 / (std::max ((double) ms, 0.01) * sampleRate)); };
+        attack = coefficient (attackMs);
+        release = coefficient (releaseMs);
+    }
+
+    void reset() noexcept
+    {
+        mono = 0;
+
+        for (auto& state : states)
+            state = splat (0);
+
+        for (auto& envelope : envelopes)
+            std::fill (std::begin (envelope), std::end (envelope), SampleType());
+    }
+
+    /** Follows the detector for numSamples <= maxBlockSize. Channel c reads detector
+        c % numDetectorChannels, so a mono sidechain drives every channel. Linked, every
+        channel gets the loudest channel's envelope.
+    */
+    void process (const SampleType* const* detector, int numDetectorChannels, int numChannels, int numSamples, bool linked) noexcept
+    {
+        numChannels = std::min (numChannels, preparedChannels);
+
+        if (numChannels <= 0 || numDetectorChannels <= 0)
+            return;
+
+        if (numChannels == 1)
+        {
+            mono = follow (detector[0], envelopes[0], numSamples, mono);
+            return;
+        }
+
+        for (int first = 0, group = 0; first < numChannels; first += (int) lanes, ++group)
+        {
+            auto numInGroup = std::min ((int) lanes, numChannels - first);
+            auto* interleaved = reinterpret_cast<SampleType*> (scratch);
+
+            for (size_t lane = 0; lane < lanes; ++lane)
+            {
+                if ((int) lane < numInGroup)
+                {
+                    auto* src = detector[(first + (int) lane) % numDetectorChannels];
+
+                    for (int i = 0; i < numSamples; ++i)
+                        interleaved[(size_t) i * lanes + lane] = std::abs (src[i]);
+                }
+                else
+                {
+                    for (int i = 0; i < numSamples; ++i)
+                        interleaved[(size_t) i * lanes + lane] = SampleType();
+                }
+            }
+
+            auto env = states[group];
+            const auto attackV = splat (attack), releaseV = splat (release), one = splat (1);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                env = step (scratch[i], env, attackV, releaseV);
+                scratch[i] = minimum (env, one);
+            }
+
+            states[group] = env;
+
+            for (int lane = 0; lane < numInGroup; ++lane)
+                for (int i = 0; i < numSamples; ++i)
+                    envelopes[first + lane][i] = interleaved[(size_t) i * lanes + (size_t) lane];
+        }
+
+        if (linked)
+        {
+            for (int channel = 1; channel < numChannels; ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    envelopes[0][i] = std::max (envelopes[0][i], envelopes[channel][i]);
+
+            for (int channel = 1; channel < numChannels; ++channel)
+                std::copy (envelopes[0], envelopes[0] + numSamples, envelopes[channel]);
+        }
+    }
+
+    /** The envelopes of the last block, one array per channel, each clamped to [0, 1]. */
+    const SampleType* const* getEnvelopes() const noexcept     { return envelopePointers; }
+
+private:
+    static constexpr size_t maxGroups = ((size_t) maxChannels + lanes - 1) / lanes;
+
+    static Vec splat (SampleType v) noexcept
+    {
+        if constexpr (std::is_floating_point<Vec>::value)
+            return v;
+        else
+            return Vec::expand (v);
+    }
+
+    static Vec minimum (Vec a, Vec b) noexcept
+    {
+        if constexpr (std::is_floating_point<Vec>::value)
+            return std::min (a, b);
+        else
+            return Vec::min (a, b);
+    }
+
+    /** One sample of the follower: attack while the input is above the envelope, release otherwise. */
+    template <typename T>
+    static T step (T x, T env, T attackCoefficient, T releaseCoefficient) noexcept
+    {
+        T coefficient;
+
+        if constexpr (std::is_floating_point<T>::value)
+            coefficient = x > env ? attackCoefficient : releaseCoefficient;
+        else
+            coefficient = releaseCoefficient + ((attackCoefficient - releaseCoefficient) & T::greaterThan (x, env));
+
+        return x + coefficient * (env - x);
+    }
+
+    SampleType follow (const SampleType* src, SampleType* dest, int numSamples, SampleType env) const noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            env = step (std::abs (src[i]), env, attack, release);
+            dest[i] = std::min (env, (SampleType) 1);
+        }
+
+        return env;
+    }
+
+    double sampleRate = 44100.0;
+    int preparedChannels = 0;
+    float attackMs = -1.0f, releaseMs = -1.0f;
+    SampleType attack = 0, release = 0;
+
+    SampleType mono = 0;
+    Vec states[maxGroups];
+    Vec scratch[maxBlockSize];
+    SampleType envelopes[maxChannels][maxBlockSize];
+    const SampleType* envelopePointers[maxChannels];
+};
+}
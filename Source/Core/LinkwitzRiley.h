@@ -0,0 +1,402 @@
+/*
+  ==============================================================================
+
+    LinkwitzRiley.h
+    Created: 19 Oct 2026 11:18:30am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "CoreUtilities.h"
+#include "Simd.h"
+
+/*  4th-order Linkwitz-Riley filter in TPT form, the same topology and maths as
+    juce::dsp::LinkwitzRileyFilter, but templated on the value type so that one
+    instance can run a whole SIMD register of channels at once. It holds a
+    single set of state, i.e. one channel or one register of channels.
+*/
+namespace lemondrive
+{
+template <typename ValueType>
+class LinkwitzRiley
+{
+public:
+    enum class Type
+    {
+        lowpass,
+        highpass,
+        allpass
+    };
+
+    void setType (Type newType) noexcept            { filterType = newType; }
+
+    void prepare (double newSampleRate) noexcept
+    {
+        sampleRate = newSampleRate;
+        update();
+        reset();
+    }
+
+    /** Recomputes the coefficients only if the cutoff actually moved. */
+    void setCutoffFrequency (float newCutoff) noexcept
+    {
+        if (newCutoff == cutoff)
+            return;
+
+        cutoff = newCutoff;
+        update();
+    }
+
+    float getCutoffFrequency() const noexcept       { return cutoff; }
+
+    /** Gives every lane of a SIMD register its own cutoff, so one register can run several
+        different filters side by side. Takes one cutoff per lane; a scalar only reads the first.
+    */
+    void setLaneCutoffFrequencies (const float* newCutoffs) noexcept
+    {
+        cutoff = newCutoffs[0];
+
+        for (size_t lane = 0; lane < getNumLanes(); ++lane)
+        {
+            auto gd = std::tan (MathConstants<double>::pi * (double) newCutoffs[lane] / sampleRate);
+            setLane (g, lane, gd);
+            setLane (h, lane, 1.0 / (1.0 + std::sqrt (2.0) * gd + gd * gd));
+        }
+
+        R2 = splat (std::sqrt (2.0));
+    }
+
+    /** The prewarped cutoff tan (pi fc / fs), which is all the TPT structure's coefficients depend on. */
+    ValueType getWarpedCutoff() const noexcept      { return g; }
+
+    /** Sets the prewarped cutoff directly, for modulation: no tan, just one division, so it is
+        cheap enough to call every sample. setCutoffFrequency() doesn't know about it, so put
+        the original value back afterwards.
+    */
+    void setWarpedCutoff (ValueType newG) noexcept
+    {
+        g = newG;
+        h = splat (1.0) / (splat (1.0) + R2 * g + g * g);
+    }
+
+    void reset() noexcept
+    {
+        s1 = s2 = s3 = s4 = splat (0.0);
+    }
+
+    ValueType processSample (ValueType x) noexcept
+    {
+        auto yH = (x - (R2 + g) * s1 - s2) * h;
+        auto yB = g * yH + s1;
+        s1 = g * yH + yB;
+        auto yL = g * yB + s2;
+        s2 = g * yB + yL;
+
+        if (filterType == Type::allpass)
+            return yL - R2 * yB + yH;
+
+        auto yH2 = ((filterType == Type::lowpass ? yL : yH) - (R2 + g) * s3 - s4) * h;
+        auto yB2 = g * yH2 + s3;
+        s3 = g * yH2 + yB2;
+        auto yL2 = g * yB2 + s4;
+        s4 = g * yB2 + yL2;
+
+        return filterType == Type::lowpass ? yL2 : yH2;
+    }
+
+    /** Crossover: low and high outputs sum to a 2nd-order allpass of the input. */
+    void processSample (ValueType x, ValueType& low, ValueType& high) noexcept
+    {
+        auto yH = (x - (R2 + g) * s1 - s2) * h;
+        auto yB = g * yH + s1;
+        s1 = g * yH + yB;
+        auto yL = g * yB + s2;
+        s2 = g * yB + yL;
+
+        auto yH2 = (yL - (R2 + g) * s3 - s4) * h;
+        auto yB2 = g * yH2 + s3;
+        s3 = g * yH2 + yB2;
+        auto yL2 = g * yB2 + s4;
+        s4 = g * yB2 + yL2;
+
+        low = yL2;
+        high = yL - R2 * yB + yH - yL2;
+    }
+
+    /** The filter's time constant, used to work out how long its tail rings. */
+    double getTimeConstantSeconds() const noexcept
+    {
+        return 1.0 / (MathConstants<double>::twoPi * (double) cutoff);
+    }
+
+    /** Broadcasts a scalar into the value type. */
+    static ValueType splat (double v) noexcept
+    {
+        if constexpr (std::is_floating_point<ValueType>::value)
+            return (ValueType) v;
+        else
+            return ValueType::expand ((typename ValueType::ElementType) v);
+    }
+
+    static constexpr size_t getNumLanes() noexcept
+    {
+        if constexpr (std::is_floating_point<ValueType>::value)
+            return 1;
+        else
+            return ValueType::size();
+    }
+
+    /** Sets one lane of the value type; for a scalar the lane index is ignored. */
+    static void setLane (ValueType& target, size_t lane, double v) noexcept
+    {
+        if constexpr (std::is_floating_point<ValueType>::value)
+        {
+            (void) lane;
+            target = (ValueType) v;
+        }
+        else
+        {
+            target.set (lane, (typename ValueType::ElementType) v);
+        }
+    }
+
+private:
+    void update() noexcept
+    {
+        auto gd = std::tan (MathConstants<double>::pi * (double) cutoff / sampleRate);
+        g = splat (gd);
+        R2 = splat (std::sqrt (2.0));
+        h = splat (1.0 / (1.0 + std::sqrt (2.0) * gd + gd * gd));
+    }
+
+    Type filterType = Type::lowpass;
+    double sampleRate = 44100.0;
+    float cutoff = 2000.0f;
+    ValueType g = splat (0.0), R2 = splat (0.0), h = splat (0.0);
+    ValueType s1 = splat (0.0), s2 = splat (0.0), s3 = splat (0.0), s4 = splat (0.0);
+};
+
+//==============================================================================
+/*  Runs a LinkwitzRiley filter over up to maxChannels channels, with each group
+    of SIMD-width channels interleaved into the lanes of one register. Mono skips
+    the interleaving and runs the scalar filter in place. The register width
+    follows the sample type, e.g. four float or two double lanes on SSE.
+*/
+template <typename SampleType>
+class MultiChannelFilter
+{
+public:
+   #if LEMONDRIVE_USE_SIMD
+    using Vec = SimdRegister<SampleType>;
+   #else
+    using Vec = SampleType;
+   #endif
+
+    static constexpr size_t lanes = sizeof (Vec) / sizeof (SampleType);
+    using Type = typename LinkwitzRiley<SampleType>::Type;
+
+    void prepare (double sampleRate, int numChannels) noexcept
+    {
+        preparedChannels = (size_t) limit (0, maxChannels, numChannels);
+        mono.prepare (sampleRate);
+
+        for (auto& group : groups)
+            group.prepare (sampleRate);
+
+        setType (filterType);
+
+        for (auto& group : groups)
+            group.setCutoffFrequency (cutoff);
+
+        mono.setCutoffFrequency (cutoff);
+    }
+
+    void setType (Type newType) noexcept
+    {
+        filterType = newType;
+        mono.setType (newType);
+
+        for (auto& group : groups)
+            group.setType ((typename LinkwitzRiley<Vec>::Type) newType);
+    }
+
+    /** A no-op unless the cutoff moved, so it is fine to call this every block. */
+    void setCutoffFrequency (float newCutoff) noexcept
+    {
+        if (newCutoff == cutoff)
+            return;
+
+        cutoff = newCutoff;
+        mono.setCutoffFrequency (newCutoff);
+
+        for (auto& group : groups)
+            group.setCutoffFrequency (newCutoff);
+    }
+
+    float getCutoffFrequency() const noexcept   { return cutoff; }
+    double getTimeConstantSeconds() const noexcept { return mono.getTimeConstantSeconds(); }
+
+    /** Highest prewarped cutoff processModulated() goes to, tan (pi * 0.45). */
+    static constexpr double maxWarpedCutoff = 6.313751514675043;
+
+    void reset() noexcept
+    {
+        mono.reset();
+
+        for (auto& group : groups)
+            group.reset();
+    }
+
+    void process (SampleType* const* channels, int numChannelsToProcess, int numSamplesToProcess) noexcept
+    {
+        auto numChannels = std::min ((size_t) std::max (0, numChannelsToProcess), preparedChannels);
+        auto numSamples = (size_t) std::max (0, numSamplesToProcess);
+
+        if (numChannels == 1)
+        {
+            auto* data = channels[0];
+
+            for (size_t i = 0; i < numSamples; ++i)
+                data[i] = mono.processSample (data[i]);
+
+            return;
+        }
+
+        // the interleaving scratch is a fixed member, so walk the block in chunks of it
+        for (size_t start = 0; start < numSamples; start += scratchSize)
+        {
+            auto length = std::min (scratchSize, numSamples - start);
+
+            for (size_t first = 0, group = 0; first < numChannels; first += lanes, ++group)
+            {
+                auto numInGroup = std::min (lanes, numChannels - first);
+                auto* interleaved = reinterpret_cast<SampleType*> (scratch);
+
+                for (size_t lane = 0; lane < lanes; ++lane)
+                {
+                    if (lane < numInGroup)
+                    {
+                        auto* src = channels[first + lane] + start;
+
+                        for (size_t i = 0; i < length; ++i)
+                            interleaved[i * lanes + lane] = src[i];
+                    }
+                    else
+                    {
+                        for (size_t i = 0; i < length; ++i)
+                            interleaved[i * lanes + lane] = SampleType();
+                    }
+                }
+
+                auto& filter = groups[group];
+
+                for (size_t i = 0; i < length; ++i)
+                    scratch[i] = filter.processSample (scratch[i]);
+
+                for (size_t lane = 0; lane < numInGroup; ++lane)
+                {
+                    auto* dest = channels[first + lane] + start;
+
+                    for (size_t i = 0; i < length; ++i)
+                        dest[i] = interleaved[i * lanes + lane];
+                }
+            }
+        }
+    }
+
+    /** Like process(), with the cutoff moved every sample: the prewarped cutoff of channel c at
+        sample i is multiplied by 1 + depth * modulation[c][i]. At LOWCUT frequencies tan is close
+        to linear, so that scales the cutoff frequency itself. The modulation is interleaved into
+        the lanes like the audio, so every lane gets its own coefficients.
+    */
+    void processModulated (SampleType* const* channels, int numChannelsToProcess, int numSamplesToProcess,
+                           const SampleType* const* modulation, SampleType depth) noexcept
+    {
+        auto numChannels = std::min ((size_t) std::max (0, numChannelsToProcess), preparedChannels);
+        auto numSamples = (size_t) std::max (0, numSamplesToProcess);
+
+        if (numChannels == 1)
+        {
+            auto* data = channels[0];
+            auto* mod = modulation[0];
+            auto base = mono.getWarpedCutoff();
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                mono.setWarpedCutoff (std::min (base * ((SampleType) 1 + depth * mod[i]), (SampleType) maxWarpedCutoff));
+                data[i] = mono.processSample (data[i]);
+            }
+
+            mono.setWarpedCutoff (base);
+            return;
+        }
+
+        for (size_t start = 0; start < numSamples; start += scratchSize)
+        {
+            auto length = std::min (scratchSize, numSamples - start);
+
+            for (size_t first = 0, group = 0; first < numChannels; first += lanes, ++group)
+            {
+                auto numInGroup = std::min (lanes, numChannels - first);
+                auto* interleaved = reinterpret_cast<SampleType*> (scratch);
+                auto* interleavedModulation = reinterpret_cast<SampleType*> (modulationScratch);
+
+                for (size_t lane = 0; lane < lanes; ++lane)
+                {
+                    auto* src = lane < numInGroup ? channels[first + lane] + start : nullptr;
+                    auto* mod = lane < numInGroup ? modulation[first + lane] + start : nullptr;
+
+                    for (size_t i = 0; i < length; ++i)
+                    {
+                        interleaved[i * lanes + lane] = src != nullptr ? src[i] : SampleType();
+                        interleavedModulation[i * lanes + lane] = mod != nullptr ? mod[i] : SampleType();
+                    }
+                }
+
+                auto& filter = groups[group];
+                const auto base = filter.getWarpedCutoff();
+                const auto one = LinkwitzRiley<Vec>::splat (1.0);
+                const auto depthV = LinkwitzRiley<Vec>::splat ((double) depth);
+                const auto maxV = LinkwitzRiley<Vec>::splat (maxWarpedCutoff);
+
+                for (size_t i = 0; i < length; ++i)
+                {
+                    filter.setWarpedCutoff (minimum (base * (one + depthV * modulationScratch[i]), maxV));
+                    scratch[i] = filter.processSample (scratch[i]);
+                }
+
+                filter.setWarpedCutoff (base);
+
+                for (size_t lane = 0; lane < numInGroup; ++lane)
+                {
+                    auto* dest = channels[first + lane] + start;
+
+                    for (size_t i = 0; i < length; ++i)
+                        dest[i] = interleaved[i * lanes + lane];
+                }
+            }
+        }
+    }
+
+private:
+    static Vec minimum (Vec a, Vec b) noexcept
+    {
+        if constexpr (std::is_floating_point<Vec>::value)
+            return std::min (a, b);
+        else
+            return Vec::min (a, b);
+    }
+
+    static constexpr size_t scratchSize = 128;
+    static constexpr size_t maxGroups = ((size_t) maxChannels + lanes - 1) / lanes;
+
+    Type filterType = Type::highpass;
+    float cutoff = 50.0f;
+    size_t preparedChannels = 0;
+    LinkwitzRiley<SampleType> mono;
+    LinkwitzRiley<Vec> groups[maxGroups];
+    Vec scratch[scratchSize], modulationScratch[scratchSize];
+};
+}
@@ -0,0 +1,404 @@
+/*
+  ==============================================================================
+
+    MultibandDrive.h
+    Created: 21 Oct 2026 9:36:05am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "CoreUtilities.h"
+#include "DriveShaper.h"
+#include "LinkwitzRiley.h"
+
+namespace lemondrive
+{
+/** Per-band and crossover settings for the multiband drive. */
+struct MultibandSettings
+{
+    static constexpr int maxBands = 4;
+
+    struct Band
+    {
+        float drive = -20.0f;
+        float curve = 0.5f;
+        float volume = 1.0f;
+    };
+
+    int numBands = 1;
+    float crossovers[maxBands - 1] { 150.0f, 1000.0f, 5000.0f };
+    Band bands[maxBands];
+
+    // the global RANGE and VOLUME still apply on top of every band
+    float range = 1.0f;
+    float volume = 1.0f;
+};
+
+//==============================================================================
+/*  Multiband version of the drive stage: 2 to 4 bands split by Linkwitz-Riley
+    crossovers, each with its own DRIVE/CURVE/VOLUME, summed back together.
+
+    Instead of one filter and one shaper per band, every band of a channel sits
+    in its own lane of a SIMD register (two registers for double on SSE/NEON),
+    so the whole crossover tree and all the band shapers run as one vectorised
+    pass per sample. The tree is three stages, each a single LinkwitzRiley on the
+    band register with a cutoff per lane:
+
+      split        every lane gets the input, low or high of the middle crossover
+      band split   lanes split their half again at the outer crossovers
+      compensation allpass at the other half's crossover (4 bands only)
+
+    so each band sees the same allpass phase as the others, and with the shapers
+    linear the bands sum to a pure allpass of the input. With 3 bands the top
+    lane takes low + high of the band split, which is that same allpass.
+
+    A band with its DRIVE at the minimum is treated as clean: it keeps the
+    shaper's small-signal gain but doesn't go through the shaper, and if no band
+    needs the shaper the shaper isn't run at all.
+*/
+template <typename SampleType>
+class MultibandDrive
+{
+public:
+   #if LEMONDRIVE_USE_SIMD
+    using Vec = SimdRegister<SampleType>;
+   #else
+    using Vec = SampleType;
+   #endif
+
+    static constexpr int maxBands = MultibandSettings::maxBands;
+    static constexpr size_t lanes = sizeof (Vec) / sizeof (SampleType);
+    static constexpr size_t numRegisters = ((size_t) maxBands + lanes - 1) / lanes;
+
+    /** DRIVEn at or below this skips the band's shaper; it is the bottom of the parameter range. */
+    static constexpr float cleanDrive = -50.0f;
+
+    void prepare (int numChannels) noexcept
+    {
+        numPreparedChannels = limit (1, maxChannels, numChannels);
+        sampleRate = 0.0;
+
+        for (size_t r = 0; r < numRegisters; ++r)
+            inGain[r] = outGain[r] = inTarget[r] = outTarget[r] = LinkwitzRiley<Vec>::splat (0.0);
+
+        reset();
+    }
+
+    /** Clears the filters; the next setSettings() jumps straight to its gains. */
+    void reset() noexcept
+    {
+        for (int channel = 0; channel < numPreparedChannels; ++channel)
+            for (auto& filters : channels[channel])
+                filters.reset();
+
+        snapToTargets = true;
+    }
+
+    /** The rate the bands are processed at, i.e. the host rate times the oversampling factor. */
+    void setSampleRate (double newSampleRate) noexcept
+    {
+        if (newSampleRate == sampleRate)
+            return;
+
+        sampleRate = newSampleRate;
+        rampLength = std::max (1, (int) std::lround (rampTimeSeconds * sampleRate));
+
+        for (int channel = 0; channel < numPreparedChannels; ++channel)
+            for (auto& filters : channels[channel])
+                filters.prepare (sampleRate);
+
+        numBands = 0;   // forces the cutoffs to be worked out again
+        snapToTargets = true;
+    }
+
+    /** Sets the band layout and targets for the next process() call. Gains glide over 20 ms;
+        crossovers move at once, which the TPT filters take without clicks.
+    */
+    void setSettings (const MultibandSettings& settings) noexcept
+    {
+        auto newNumBands = limit (2, maxBands, settings.numBands);
+
+        // the crossovers in use have to be in order for the bands to come out in order
+        float crossovers[maxBands - 1];
+        std::copy (std::begin (settings.crossovers), std::end (settings.crossovers), crossovers);
+        std::sort (crossovers, crossovers + newNumBands - 1);
+
+        for (auto& f : crossovers)
+            f = limit (10.0f, (float) (0.45 * sampleRate), f);
+
+        if (newNumBands != numBands || ! std::equal (crossovers, crossovers + newNumBands - 1, currentCrossovers))
+        {
+            if (newNumBands != numBands)
+                reset();
+
+            numBands = newNumBands;
+            std::copy (crossovers, crossovers + maxBands - 1, currentCrossovers);
+            updateCrossovers();
+        }
+
+        const auto pi = MathConstants<SampleType>::pi;
+        SampleType inTargets[numRegisters * lanes] {}, outTargets[numRegisters * lanes] {}, shaped[numRegisters * lanes] {};
+        bool shapeAny = false;
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            auto& b = settings.bands[band];
+
+            inTargets[band] = Decibels::decibelsToGain ((SampleType) b.drive) * (SampleType) settings.range
+                                * pi / ((SampleType) 1 - (SampleType) b.curve);
+            outTargets[band] = (SampleType) 2 / pi * (SampleType) b.volume * (SampleType) settings.volume;
+            shaped[band] = b.drive > cleanDrive ? (SampleType) 1 : (SampleType) 0;
+            shapeAny = shapeAny || b.drive > cleanDrive;
+        }
+
+        // unchanged targets leave any glide that is under way alone
+        if (! snapToTargets && shapeAny == anyShaped
+             && std::equal (std::begin (inTargets), std::end (inTargets), inTargetValues)
+             && std::equal (std::begin (outTargets), std::end (outTargets), outTargetValues))
+            return;
+
+        anyShaped = shapeAny;
+        std::copy (std::begin (inTargets), std::end (inTargets), inTargetValues);
+        std::copy (std::begin (outTargets), std::end (outTargets), outTargetValues);
+
+        for (size_t r = 0; r < numRegisters; ++r)
+        {
+            inTarget[r] = fromLanes (inTargets + r * lanes);
+            outTarget[r] = fromLanes (outTargets + r * lanes);
+            shapedMask[r] = fromLanes (shaped + r * lanes);
+        }
+
+        if (snapToTargets)
+        {
+            snapToTargets = false;
+            rampRemaining = 0;
+
+            for (size_t r = 0; r < numRegisters; ++r)
+            {
+                inGain[r] = inTarget[r];
+                outGain[r] = outTarget[r];
+            }
+
+            return;
+        }
+
+        rampRemaining = rampLength;
+        const auto scale = (SampleType) 1 / (SampleType) rampLength;
+
+        for (size_t r = 0; r < numRegisters; ++r)
+        {
+            inStep[r] = (inTarget[r] - inGain[r]) * scale;
+            outStep[r] = (outTarget[r] - outGain[r]) * scale;
+        }
+    }
+
+    /** Splits, drives and sums every channel in place. */
+    void process (SampleType* const* data, int numChannelsToProcess, int numSamples) noexcept
+    {
+        auto numChannels = std::min (numChannelsToProcess, numPreparedChannels);
+
+        // every channel has to glide the same way, so each one starts from the block's first gains
+        Vec startIn[numRegisters], startOut[numRegisters];
+        std::copy (std::begin (inGain), std::end (inGain), startIn);
+        std::copy (std::begin (outGain), std::end (outGain), startOut);
+        auto startRemaining = rampRemaining;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            std::copy (std::begin (startIn), std::end (startIn), inGain);
+            std::copy (std::begin (startOut), std::end (startOut), outGain);
+            rampRemaining = startRemaining;
+
+            processChannel (data[channel], numSamples, channels[channel]);
+        }
+
+        if (numChannels <= 0)
+            rampRemaining = std::max (0, rampRemaining - numSamples);
+
+        if (rampRemaining == 0)
+        {
+            std::copy (std::begin (inTarget), std::end (inTarget), inGain);
+            std::copy (std::begin (outTarget), std::end (outTarget), outGain);
+        }
+    }
+
+    /** Sum of the bands' small-signal gains, the most a quiet input can be amplified by. */
+    SampleType getSmallSignalGain() const noexcept
+    {
+        SampleType current = 0, target = 0;
+
+        for (size_t r = 0; r < numRegisters; ++r)
+        {
+            current += sumLanes (inGain[r] * outGain[r]);
+            target += sumLanes (inTarget[r] * outTarget[r]);
+        }
+
+        return std::max (current, target);
+    }
+
+    /** The crossover tree rings longest at its lowest crossover, once per stage in the path. */
+    static double getTailLengthSeconds (const MultibandSettings& settings, double decayTimeConstants) noexcept
+    {
+        if (settings.numBands < 2)
+            return 0.0;
+
+        auto numCrossovers = std::min (settings.numBands, maxBands) - 1;
+        auto lowest = *std::min_element (settings.crossovers, settings.crossovers + numCrossovers);
+
+        return std::min (3, numCrossovers) * decayTimeConstants * std::sqrt (2.0)
+                 / (MathConstants<double>::twoPi * (double) std::max (10.0f, lowest));
+    }
+
+private:
+    /** One band register's worth of the crossover tree, for one channel. */
+    struct Filters
+    {
+        LinkwitzRiley<Vec> split, bandSplit, compensation;
+
+        void prepare (double rate) noexcept
+        {
+            split.prepare (rate);
+            bandSplit.prepare (rate);
+            compensation.prepare (rate);
+            compensation.setType (LinkwitzRiley<Vec>::Type::allpass);
+        }
+
+        void reset() noexcept
+        {
+            split.reset();
+            bandSplit.reset();
+            compensation.reset();
+        }
+    };
+
+    using ChannelFilters = std::array<Filters, numRegisters>;
+
+    void processChannel (SampleType* data, int numSamples, ChannelFilters& filters) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto input = LinkwitzRiley<Vec>::splat ((double) data[i]);
+            auto sum = LinkwitzRiley<Vec>::splat (0.0);
+
+            for (size_t r = 0; r < numRegisters; ++r)
+            {
+                Vec low, high;
+                filters[r].split.processSample (input, low, high);
+                auto bands = low * splitLow[r] + high * splitHigh[r];
+
+                if (numBands > 2)
+                {
+                    filters[r].bandSplit.processSample (bands, low, high);
+                    bands = low * bandLow[r] + high * bandHigh[r];
+                }
+
+                if (numBands > 3)
+                    bands = filters[r].compensation.processSample (bands);
+
+                auto driven = bands * inGain[r];
+
+                if (anyShaped)
+                    driven = driven + shapedMask[r] * (DriveShaper::fastAtan (driven) - driven);
+
+                sum = sum + driven * outGain[r];
+
+                if (rampRemaining > 0)
+                {
+                    inGain[r] = inGain[r] + inStep[r];
+                    outGain[r] = outGain[r] + outStep[r];
+                }
+            }
+
+            if (rampRemaining > 0)
+                --rampRemaining;
+
+            data[i] = sumLanes (sum);
+        }
+    }
+
+    /** Works out which half of each split every lane keeps, and the per-lane cutoffs. */
+    void updateCrossovers() noexcept
+    {
+        const auto* f = currentCrossovers;
+
+        // 2 bands split once at the only crossover; 3 and 4 split first at the middle one
+        const auto numBelowSplit = numBands == 2 ? 1 : 2;
+        const auto splitCutoff = numBands == 2 ? f[0] : f[1];
+
+        SampleType keepSplitLow[numRegisters * lanes] {}, keepSplitHigh[numRegisters * lanes] {};
+        SampleType keepBandLow[numRegisters * lanes] {}, keepBandHigh[numRegisters * lanes] {};
+        float splitCutoffs[numRegisters * lanes], bandCutoffs[numRegisters * lanes], compensationCutoffs[numRegisters * lanes];
+
+        for (size_t lane = 0; lane < numRegisters * lanes; ++lane)
+        {
+            const auto band = (int) lane;
+            const auto active = band < numBands;
+
+            keepSplitLow[lane] = active && band < numBelowSplit ? (SampleType) 1 : (SampleType) 0;
+            keepSplitHigh[lane] = active && band >= numBelowSplit ? (SampleType) 1 : (SampleType) 0;
+
+            // the lower pair splits at the first crossover, the upper pair at the third; a lone
+            // top band (3 bands) keeps both halves, i.e. the allpass that matches its neighbours
+            keepBandLow[lane] = active && (band % 2 == 0) ? (SampleType) 1 : (SampleType) 0;
+            keepBandHigh[lane] = active && (band % 2 == 1 || (numBands == 3 && band == 2)) ? (SampleType) 1 : (SampleType) 0;
+
+            splitCutoffs[lane] = splitCutoff;
+            bandCutoffs[lane] = band < 2 || numBands == 3 ? f[0] : f[2];
+            compensationCutoffs[lane] = band < 2 ? f[2] : f[0];
+        }
+
+        for (size_t r = 0; r < numRegisters; ++r)
+        {
+            splitLow[r] = fromLanes (keepSplitLow + r * lanes);
+            splitHigh[r] = fromLanes (keepSplitHigh + r * lanes);
+            bandLow[r] = fromLanes (keepBandLow + r * lanes);
+            bandHigh[r] = fromLanes (keepBandHigh + r * lanes);
+        }
+
+        for (int channel = 0; channel < numPreparedChannels; ++channel)
+        {
+            for (size_t r = 0; r < numRegisters; ++r)
+            {
+                channels[channel][r].split.setLaneCutoffFrequencies (splitCutoffs + r * lanes);
+                channels[channel][r].bandSplit.setLaneCutoffFrequencies (bandCutoffs + r * lanes);
+                channels[channel][r].compensation.setLaneCutoffFrequencies (compensationCutoffs + r * lanes);
+            }
+        }
+    }
+
+    static Vec fromLanes (const SampleType* values) noexcept
+    {
+        auto v = LinkwitzRiley<Vec>::splat (0.0);
+
+        for (size_t lane = 0; lane < lanes; ++lane)
+            LinkwitzRiley<Vec>::setLane (v, lane, (double) values[lane]);
+
+        return v;
+    }
+
+    static SampleType sumLanes (Vec v) noexcept
+    {
+        if constexpr (std::is_floating_point<Vec>::value)
+            return v;
+        else
+            return v.sum();
+    }
+
+    static constexpr double rampTimeSeconds = 0.02;
+
+    ChannelFilters channels[maxChannels];
+    int numPreparedChannels = 1;
+    double sampleRate = 0.0;
+    int numBands = 0;
+    float currentCrossovers[maxBands - 1] {};
+    SampleType inTargetValues[numRegisters * lanes] {}, outTargetValues[numRegisters * lanes] {};
+
+    Vec splitLow[numRegisters], splitHigh[numRegisters], bandLow[numRegisters], bandHigh[numRegisters];
+    Vec inGain[numRegisters], outGain[numRegisters], inTarget[numRegisters], outTarget[numRegisters];
+    Vec inStep[numRegisters], outStep[numRegisters], shapedMask[numRegisters];
+    bool anyShaped = false, snapToTargets = true;
+    int rampLength = 1, rampRemaining = 0;
+};
+}
@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+    Simd.h
+    Created: 22 Oct 2026 9:31:02am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/*  A stand-in for juce::dsp::SIMDRegister covering the operations the core
+    uses, on SSE2 or NEON. Define LEMONDRIVE_USE_SIMD to 0 to build the scalar
+    paths only; everything that uses SimdRegister also has a scalar fallback.
+*/
+#ifndef LEMONDRIVE_USE_SIMD
+ #if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2) \
+      || defined (__aarch64__) || defined (_M_ARM64)
+  #define LEMONDRIVE_USE_SIMD 1
+ #else
+  #define LEMONDRIVE_USE_SIMD 0
+ #endif
+#endif
+
+#if LEMONDRIVE_USE_SIMD
+ #if defined (__aarch64__) || defined (_M_ARM64)
+  #include <arm_neon.h>
+  #define LEMONDRIVE_SIMD_NEON 1
+ #else
+  #include <emmintrin.h>
+  #define LEMONDRIVE_SIMD_SSE2 1
+ #endif
+
+namespace lemondrive
+{
+    namespace detail
+    {
+        template <typename ElementType>
+        struct SimdOps;
+
+       #if LEMONDRIVE_SIMD_SSE2
+        template <>
+        struct SimdOps<float>
+        {
+            using NativeType = __m128;
+
+            static NativeType expand (float s) noexcept                         { return _mm_set1_ps (s); }
+            static NativeType load (const float* p) noexcept                    { return _mm_load_ps (p); }
+            static void store (float* p, NativeType v) noexcept                 { _mm_store_ps (p, v); }
+            static NativeType add (NativeType a, NativeType b) noexcept         { return _mm_add_ps (a, b); }
+            static NativeType sub (NativeType a, NativeType b) noexcept         { return _mm_sub_ps (a, b); }
+            static NativeType mul (NativeType a, NativeType b) noexcept         { return _mm_mul_ps (a, b); }
+            static NativeType div (NativeType a, NativeType b) noexcept         { return _mm_div_ps (a, b); }
+            static NativeType min (NativeType a, NativeType b) noexcept         { return _mm_min_ps (a, b); }
+            static NativeType max (NativeType a, NativeType b) noexcept         { return _mm_max_ps (a, b); }
+            static NativeType greaterThan (NativeType a, NativeType b) noexcept { return _mm_cmpgt_ps (a, b); }
+            static NativeType bitAnd (NativeType a, NativeType b) noexcept      { return _mm_and_ps (a, b); }
+        };
+
+        template <>
+        struct SimdOps<double>
+        {
+            using NativeType = __m128d;
+
+            static NativeType expand (double s) noexcept                        { return _mm_set1_pd (s); }
+            static NativeType load (const double* p) noexcept                   { return _mm_load_pd (p); }
+            static void store (double* p, NativeType v) noexcept                { _mm_store_pd (p, v); }
+            static NativeType add (NativeType a, NativeType b) noexcept         { return _mm_add_pd (a, b); }
+            static NativeType sub (NativeType a, NativeType b) noexcept         { return _mm_sub_pd (a, b); }
+            static NativeType mul (NativeType a, NativeType b) noexcept         { return _mm_mul_pd (a, b); }
+            static NativeType div (NativeType a, NativeType b) noexcept         { return _mm_div_pd (a, b); }
+            static NativeType min (NativeType a, NativeType b) noexcept         { return _mm_min_pd (a, b); }
+            static NativeType max (NativeType a, NativeType b) noexcept         { return _mm_max_pd (a, b); }
+            static NativeType greaterThan (NativeType a, NativeType b) noexcept { return _mm_cmpgt_pd (a, b); }
+            static NativeType bitAnd (NativeType a, NativeType b) noexcept      { return _mm_and_pd (a, b); }
+        };
+       #else
+        template <>
+        struct SimdOps<float>
+        {
+            using NativeType = float32x4_t;
+
+            static NativeType expand (float s) noexcept                         { return vdupq_n_f32 (s); }
+            static NativeType load (const float* p) noexcept                    { return vld1q_f32 (p); }
+            static void store (float* p, NativeType v) noexcept                 { vst1q_f32 (p, v); }
+            static NativeType add (NativeType a, NativeType b) noexcept         { return vaddq_f32 (a, b); }
+            static NativeType sub (NativeType a, NativeType b) noexcept         { return vsubq_f32 (a, b); }
+            static NativeType mul (NativeType a, NativeType b) noexcept         { return vmulq_f32 (a, b); }
+            static NativeType div (NativeType a, NativeType b) noexcept         { return vdivq_f32 (a, b); }
+            static NativeType min (NativeType a, NativeType b) noexcept         { return vminq_f32 (a, b); }
+            static NativeType max (NativeType a, NativeType b) noexcept         { return vmaxq_f32 (a, b); }
+            static NativeType greaterThan (NativeType a, NativeType b) noexcept { return vreinterpretq_f32_u32 (vcgtq_f32 (a, b)); }
+
+            static NativeType bitAnd (NativeType a, NativeType b) noexcept
+            {
+                return vreinterpretq_f32_u32 (vandq_u32 (vreinterpretq_u32_f32 (a), vreinterpretq_u32_f32 (b)));
+            }
+        };
+
+        template <>
+        struct SimdOps<double>
+        {
+            using NativeType = float64x2_t;
+
+            static NativeType expand (double s) noexcept                        { return vdupq_n_f64 (s); }
+            static NativeType load (const double* p) noexcept                   { return vld1q_f64 (p); }
+            static void store (double* p, NativeType v) noexcept                { vst1q_f64 (p, v); }
+            static NativeType add (NativeType a, NativeType b) noexcept         { return vaddq_f64 (a, b); }
+            static NativeType sub (NativeType a, NativeType b) noexcept         { return vsubq_f64 (a, b); }
+            static NativeType mul (NativeType a, NativeType b) noexcept         { return vmulq_f64 (a, b); }
+            static NativeType div (NativeType a, NativeType b) noexcept         { return vdivq_f64 (a, b); }
+            static NativeType min (NativeType a, NativeType b) noexcept         { return vminq_f64 (a, b); }
+            static NativeType max (NativeType a, NativeType b) noexcept         { return vmaxq_f64 (a, b); }
+            static NativeType greaterThan (NativeType a, NativeType b) noexcept { return vreinterpretq_f64_u64 (vcgtq_f64 (a, b)); }
+
+            static NativeType bitAnd (NativeType a, NativeType b) noexcept
+            {
+                return vreinterpretq_f64_u64 (vandq_u64 (vreinterpretq_u64_f64 (a), vreinterpretq_u64_f64 (b)));
+            }
+        };
+       #endif
+    }
+
+    //==============================================================================
+    /** One native register of float or double lanes, with the same names as juce::dsp::SIMDRegister.
+        fromRawArray() and copyToRawArray() expect register-aligned pointers.
+    */
+    template <typename Type>
+    struct SimdRegister
+    {
+        using ElementType = Type;
+        using NativeOps = detail::SimdOps<ElementType>;
+        using NativeType = typename NativeOps::NativeType;
+
+        static constexpr size_t SIMDRegisterSize = sizeof (NativeType);
+        static constexpr size_t SIMDNumElements = sizeof (NativeType) / sizeof (ElementType);
+
+        NativeType value;
+
+        static constexpr size_t size() noexcept                                 { return SIMDNumElements; }
+
+        static SimdRegister fromNative (NativeType v) noexcept                  { return { v }; }
+        static SimdRegister expand (ElementType s) noexcept                     { return { NativeOps::expand (s) }; }
+        static SimdRegister fromRawArray (const ElementType* p) noexcept        { return { NativeOps::load (p) }; }
+        void copyToRawArray (ElementType* p) const noexcept                     { NativeOps::store (p, value); }
+
+        static SimdRegister min (SimdRegister a, SimdRegister b) noexcept       { return { NativeOps::min (a.value, b.value) }; }
+        static SimdRegister max (SimdRegister a, SimdRegister b) noexcept       { return { NativeOps::max (a.value, b.value) }; }
+
+        /** All bits set in the lanes where a > b, for use with operator&. */
+        static SimdRegister greaterThan (SimdRegister a, SimdRegister b) noexcept { return { NativeOps::greaterThan (a.value, b.value) }; }
+
+        SimdRegister operator+ (SimdRegister other) const noexcept              { return { NativeOps::add (value, other.value) }; }
+        SimdRegister operator- (SimdRegister other) const noexcept              { return { NativeOps::sub (value, other.value) }; }
+        SimdRegister operator* (SimdRegister other) const noexcept              { return { NativeOps::mul (value, other.value) }; }
+        SimdRegister operator/ (SimdRegister other) const noexcept              { return { NativeOps::div (value, other.value) }; }
+        SimdRegister operator& (SimdRegister other) const noexcept              { return { NativeOps::bitAnd (value, other.value) }; }
+
+        SimdRegister operator+ (ElementType s) const noexcept                   { return *this + expand (s); }
+        SimdRegister operator- (ElementType s) const noexcept                   { return *this - expand (s); }
+        SimdRegister operator* (ElementType s) const noexcept                   { return *this * expand (s); }
+
+        SimdRegister& operator+= (SimdRegister other) noexcept                  { return *this = *this + other; }
+        SimdRegister& operator-= (SimdRegister other) noexcept                  { return *this = *this - other; }
+        SimdRegister& operator*= (SimdRegister other) noexcept                  { return *this = *this * other; }
+
+        ElementType get (size_t lane) const noexcept
+        {
+            alignas (SIMDRegisterSize) ElementType lanes[SIMDNumElements];
+            copyToRawArray (lanes);
+            return lanes[lane];
+        }
+
+        void set (size_t lane, ElementType s) noexcept
+        {
+            alignas (SIMDRegisterSize) ElementType lanes[SIMDNumElements];
+            copyToRawArray (lanes);
+            lanes[lane] = s;
+            value = NativeOps::load (lanes);
+        }
+
+        ElementType sum() const noexcept
+        {
+            alignas (SIMDRegisterSize) ElementType lanes[SIMDNumElements];
+            copyToRawArray (lanes);
+
+            auto total = ElementType();
+
+            for (auto lane : lanes)
+                total += lane;
+
+            return total;
+        }
+
+        static ElementType* getNextSIMDAlignedPtr (ElementType* p) noexcept
+        {
+            auto address = reinterpret_cast<std::uintptr_t> (p);
+            return reinterpret_cast<ElementType*> ((address + SIMDRegisterSize - 1) & ~(std::uintptr_t) (SIMDRegisterSize - 1));
+        }
+    };
+}
+#endif
@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+    TiltFilter.h
+    Created: 20 Oct 2026 10:37:44am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "CoreUtilities.h"
+
+/*  First-order tilt around a fixed pivot, built from a TPT one-pole split into
+    low and high parts. In emphasis mode the highs go up by tiltDb/2 and the
+    lows down by the same amount; de-emphasis mode is the exact inverse (same
+    bilinear mapping, pole and zero swapped), so an emphasis/de-emphasis pair
+    around the drive changes which frequencies saturate first without changing
+    the linear response of the chain.
+*/
+namespace lemondrive
+{
+template <typename SampleType>
+class TiltFilter
+{
+public:
+    enum class Mode
+    {
+        emphasis,
+        deEmphasis
+    };
+
+    static constexpr double pivotFrequency = 700.0;
+
+    void setMode (Mode newMode) noexcept
+    {
+        mode = newMode;
+        update();
+    }
+
+    void prepare (double newSampleRate, int numChannels) noexcept
+    {
+        sampleRate = newSampleRate;
+        preparedChannels = limit (0, maxChannels, numChannels);
+        reset();
+        update();
+    }
+
+    /** Recomputes the coefficients only if the tilt actually moved. */
+    void setTilt (float newTiltDb) noexcept
+    {
+        if (newTiltDb == tiltDb)
+            return;
+
+        tiltDb = newTiltDb;
+        update();
+    }
+
+    float getTilt() const noexcept      { return tiltDb; }
+    bool isNeutral() const noexcept     { return tiltDb == 0.0f; }
+
+    void reset() noexcept
+    {
+        std::fill (std::begin (state), std::end (state), SampleType());
+    }
+
+    void process (SampleType* const* channels, int numChannelsToProcess, int numSamples) noexcept
+    {
+        auto numChannels = std::min (numChannelsToProcess, preparedChannels);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = channels[channel];
+            auto s = state[channel];
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto x = data[i];
+                auto v = (x - s) * G;
+                auto low = v + s;
+                s = low + v;
+
+                data[i] = lowGain * low + highGain * (x - low);
+            }
+
+            state[channel] = s;
+        }
+    }
+
+private:
+    void update() noexcept
+    {
+        // the shelf's high/low ratio is the full tilt; split it evenly around the pivot
+        auto ratio = Decibels::decibelsToGain ((double) tiltDb);
+        auto g = std::tan (MathConstants<double>::pi * std::min (pivotFrequency, 0.45 * sampleRate) / sampleRate);
+        auto halfTilt = std::sqrt (ratio);
+
+        if (mode == Mode::deEmphasis)
+        {
+            g /= ratio;
+            lowGain = (SampleType) halfTilt;
+            highGain = (SampleType) (halfTilt / ratio);
+        }
+        else
+        {
+            lowGain = (SampleType) (1.0 / halfTilt);
+            highGain = (SampleType) (ratio / halfTilt);
+        }
+
+        G = (SampleType) (g / (1.0 + g));
+    }
+
+    Mode mode = Mode::emphasis;
+    double sampleRate = 44100.0;
+    float tiltDb = 0.0f;
+    SampleType G = 0, lowGain = 1, highGain = 1;
+    int preparedChannels = 0;
+    SampleType state[maxChannels] {};
+};
+}
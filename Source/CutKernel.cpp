@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+    CutKernel.cpp
+    Created: 23 Oct 2026 10:17:45am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#include "CutKernel.h"
+#include "Core/DriveCore.h"
+
+CutKernel::CutKernel (Type t, float c, double rate)
+    : type (t), cutoff (c), sampleRate (rate)
+{
+    const auto length = getKernelLength (type, sampleRate);
+    numPartitions = length / partitionSize;
+
+    // the zero-phase response, on a grid with room for it to decay before it wraps around
+    const auto designOrder = juce::findHighestSetBit ((juce::uint32) length) + 2;
+    const auto designSize = 1 << designOrder;
+
+    juce::dsp::FFT designFFT (designOrder);
+    std::vector<float> buffer ((size_t) designSize * 2);
+    auto* bins = reinterpret_cast<std::complex<float>*> (buffer.data());
+
+    for (int k = 0; k <= designSize / 2; ++k)
+        bins[k] = getMagnitude (type, cutoff, (double) k * sampleRate / (double) designSize, sampleRate);
+
+    for (int k = designSize / 2 + 1; k < designSize; ++k)
+        bins[k] = bins[designSize - k];
+
+    designFFT.performRealOnlyInverseTransform (buffer.data());
+
+    // centred on length / 2 and Blackman-windowed
+    std::vector<float> kernel ((size_t) length), window ((size_t) length);
+    double sum = 0.0, windowSum = 0.0;
+
+    for (int n = 0; n < length; ++n)
+    {
+        auto phase = juce::MathConstants<double>::twoPi * (double) n / (double) length;
+        window[(size_t) n] = (float) (0.42 - 0.5 * std::cos (phase) + 0.08 * std::cos (2.0 * phase));
+        kernel[(size_t) n] = buffer[(size_t) ((n - length / 2 + designSize) % designSize)] * window[(size_t) n];
+
+        sum += kernel[(size_t) n];
+        windowSum += window[(size_t) n];
+    }
+
+    // truncation leaves a little DC behind, so pin it: none through LOWCUT, unity through HIGHCUT
+    if (type == Type::lowCut)
+    {
+        auto offset = (float) (sum / windowSum);
+
+        for (int n = 0; n < length; ++n)
+            kernel[(size_t) n] -= offset * window[(size_t) n];
+    }
+    else if (sum > 0.0)
+    {
+        juce::FloatVectorOperations::multiply (kernel.data(), (float) (1.0 / sum), length);
+    }
+
+    // each partition zero-padded to the FFT size and transformed
+    juce::dsp::FFT fft (partitionOrder + 1);
+    std::vector<float> block ((size_t) partitionSize * 4);
+    spectra.resize ((size_t) numPartitions * numBins);
+
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        std::fill (block.begin(), block.end(), 0.0f);
+        std::copy_n (kernel.begin() + partition * partitionSize, partitionSize, block.begin());
+        fft.performRealOnlyForwardTransform (block.data(), true);
+
+        auto* transformed = reinterpret_cast<const std::complex<float>*> (block.data());
+        std::copy_n (transformed, numBins, spectra.begin() + partition * numBins);
+    }
+}
+
+int CutKernel::getKernelLength (Type type, double sampleRate) noexcept
+{
+    // the zero-phase response lasts about as long as the minimum-phase one rings, on both sides
+    auto seconds = type == Type::lowCut ? 0.16 : 0.01;
+    return juce::jmax (partitionSize, juce::nextPowerOfTwo ((int) std::ceil (seconds * sampleRate)));
+}
+
+float CutKernel::getMagnitude (Type type, float cutoff, double frequency, double sampleRate) noexcept
+{
+    using Core = lemondrive::DriveCore<float>;
+
+    if (type == Type::highCut && cutoff >= Core::highCutBypassFrequency)
+        return 1.0f;
+
+    // the same prewarped frequency as the TPT filters, capped where they cap HIGHCUT
+    auto cut = juce::jmin ((double) cutoff, 0.45 * sampleRate);
+    auto w = std::tan (juce::MathConstants<double>::pi * juce::jmin (frequency / sampleRate, 0.5 - 1.0e-9))
+               / std::tan (juce::MathConstants<double>::pi * cut / sampleRate);
+
+    // LR4 is a squared Butterworth, so |H| = 1 / (1 + w^4) for the lowpass
+    auto w4 = w * w * w * w;
+    return (float) (type == Type::highCut ? 1.0 / (1.0 + w4) : 1.0 / (1.0 + 1.0 / w4));
+}
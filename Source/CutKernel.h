@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    CutKernel.h
+    Created: 23 Oct 2026 10:17:45am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*  Linear-phase FIR for LOWCUT or HIGHCUT at one cutoff and sample rate.
+
+    The kernel has the magnitude response of the minimum-phase LR4 filter it
+    stands in for, prewarping included, and no phase shift: the LR4 magnitude
+    is sampled on a grid four times the kernel length, transformed back to a
+    zero-phase impulse response, then centred and windowed. The window limits
+    how steep it gets, so a 20 Hz LOWCUT matches to the cutoff and is a few dB
+    shallower an octave below it.
+
+    It is stored the way the partitioned convolver reads it: split into
+    partitionSize-tap pieces, each zero-padded and transformed. Kernels are
+    immutable once built, so the audio thread reads them without locking.
+*/
+class CutKernel : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<CutKernel>;
+
+    enum class Type
+    {
+        lowCut,     // LR4 highpass
+        highCut     // LR4 lowpass; at or above the bypass frequency a plain delay
+    };
+
+    /** Block size of the convolution. The FFTs are twice this, and a filter adds this
+        much latency on top of its kernel's delay.
+    */
+    static constexpr int partitionOrder = 8;
+    static constexpr int partitionSize = 1 << partitionOrder;
+    static constexpr int numBins = partitionSize + 1;
+
+    /** Designs and transforms the kernel, so never call this on the audio thread. */
+    CutKernel (Type type, float cutoff, double sampleRate);
+
+    /** Taps in a kernel of this type at this rate, always a multiple of partitionSize.
+        LOWCUT kernels are long enough for a 20 Hz LR4 to ring out; HIGHCUT ones are short.
+    */
+    static int getKernelLength (Type type, double sampleRate) noexcept;
+
+    /** Delay through one filter: half the kernel plus one partition. */
+    static int getLatencySamples (Type type, double sampleRate) noexcept
+    {
+        return getKernelLength (type, sampleRate) / 2 + partitionSize;
+    }
+
+    Type getType() const noexcept           { return type; }
+    float getCutoff() const noexcept        { return cutoff; }
+    double getSampleRate() const noexcept   { return sampleRate; }
+    int getNumPartitions() const noexcept   { return numPartitions; }
+
+    /** The non-negative frequency bins of one transformed partition. */
+    const std::complex<float>* getPartition (int index) const noexcept
+    {
+        return spectra.data() + (size_t) index * numBins;
+    }
+
+private:
+    static float getMagnitude (Type type, float cutoff, double frequency, double sampleRate) noexcept;
+
+    const Type type;
+    const float cutoff;
+    const double sampleRate;
+    int numPartitions = 0;
+    std::vector<std::complex<float>> spectra;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CutKernel)
+};
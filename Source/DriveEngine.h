@@ -0,0 +1,904 @@
+/*
+  ==============================================================================
+
+    DriveEngine.h
+    Created: 19 Oct 2026 4:52:16pm
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "Core/DriveCore.h"
+#include "ShaperTable.h"
+#include "LinearPhaseCut.h"
+#include "MeterFeed.h"
+#include "MorphSnapshots.h"
+#include "LoadProfiler.h"
+
+// the plugin side uses the core's settings types as they are
+using ChainSettings = lemondrive::ChainSettings;
+using MultibandSettings = lemondrive::MultibandSettings;
+
+/** The raw parameter values the engine reads, cached once by the processor so
+    neither precision ever looks a parameter up by name.
+*/
+struct DriveParameters
+{
+    // order matches the SHAPER parameter choices
+    enum class ShaperMode
+    {
+        fast,
+        reference,
+        table,
+        diode,
+        diodeTable
+    };
+
+    // order matches the ADAA parameter choices
+    enum class AdaaMode
+    {
+        off,
+        firstOrder,
+        secondOrder
+    };
+
+    std::atomic<float>* drive = nullptr;
+    std::atomic<float>* range = nullptr;
+    std::atomic<float>* volume = nullptr;
+    std::atomic<float>* lowCut = nullptr;
+    std::atomic<float>* highCut = nullptr;
+    std::atomic<float>* curve = nullptr;
+    // order matches the CUTMODE parameter choices
+    enum class CutMode
+    {
+        minimumPhase,
+        linearPhase
+    };
+
+    std::atomic<float>* shaper = nullptr;
+    std::atomic<float>* adaa = nullptr;
+    std::atomic<float>* oversampling = nullptr;
+    std::atomic<float>* osFilter = nullptr;
+    std::atomic<float>* osOffline = nullptr;
+    std::atomic<float>* smoothing = nullptr;
+    std::atomic<float>* link = nullptr;
+    std::atomic<float>* tilt = nullptr;
+    std::atomic<float>* morph = nullptr;
+    std::atomic<float>* cutMode = nullptr;
+
+    // order matches the DYNSOURCE parameter choices
+    enum class DynamicsSource
+    {
+        off,
+        input,
+        sidechain
+    };
+
+    // envelope modulation of DRIVE and LOWCUT
+    std::atomic<float>* dynSource = nullptr;
+    std::atomic<float>* dynAttack = nullptr;
+    std::atomic<float>* dynRelease = nullptr;
+    std::atomic<float>* dynDrive = nullptr;
+    std::atomic<float>* dynCut = nullptr;
+
+    // multiband mode; BANDS index 0 is the plain single-band drive
+    std::atomic<float>* bands = nullptr;
+    std::atomic<float>* crossovers[MultibandSettings::maxBands - 1] {};
+    std::atomic<float>* bandDrive[MultibandSettings::maxBands] {};
+    std::atomic<float>* bandCurve[MultibandSettings::maxBands] {};
+    std::atomic<float>* bandVolume[MultibandSettings::maxBands] {};
+
+    // A/B slots; while both are stored they replace the live values of the smoothed parameters
+    TripleBuffer<MorphState>* snapshots = nullptr;
+
+    ParameterSnapshot getLiveSnapshot() const noexcept
+    {
+        ParameterSnapshot live;
+        live[ParameterSnapshot::drive] = drive->load();
+        live[ParameterSnapshot::range] = range->load();
+        live[ParameterSnapshot::volume] = volume->load();
+        live[ParameterSnapshot::lowCut] = lowCut->load();
+        live[ParameterSnapshot::highCut] = highCut->load();
+        live[ParameterSnapshot::curve] = curve->load();
+        live[ParameterSnapshot::tilt] = tilt->load();
+        return live;
+    }
+
+    DynamicsSource getDynamicsSource() const noexcept
+    {
+        return dynSource != nullptr ? (DynamicsSource) (int) dynSource->load() : DynamicsSource::off;
+    }
+
+    lemondrive::DynamicsSettings getDynamicsSettings() const noexcept
+    {
+        lemondrive::DynamicsSettings settings;
+        settings.enabled = getDynamicsSource() != DynamicsSource::off;
+
+        if (settings.enabled)
+        {
+            settings.attackMs = dynAttack->load();
+            settings.releaseMs = dynRelease->load();
+            settings.driveDb = dynDrive->load();
+            settings.cutOctaves = dynCut->load();
+        }
+
+        return settings;
+    }
+
+    /** The band layout and per-band values; RANGE and VOLUME are left for the caller to fill in. */
+    MultibandSettings getMultibandSettings() const noexcept
+    {
+        MultibandSettings settings;
+
+        if (bands == nullptr)
+            return settings;
+
+        settings.numBands = (int) bands->load() + 1;
+
+        for (int i = 0; i < MultibandSettings::maxBands - 1; ++i)
+            settings.crossovers[i] = crossovers[i]->load();
+
+        for (int band = 0; band < MultibandSettings::maxBands; ++band)
+            settings.bands[band] = { bandDrive[band]->load(), bandCurve[band]->load(), bandVolume[band]->load() };
+
+        return settings;
+    }
+};
+
+/** The audio thread's side of the table shaper hand-off: the table in use and,
+    while a CURVE change is being faded in, the one it is fading away from.
+*/
+struct ShaperTableState
+{
+    static constexpr int fadeLength = 2048;
+
+    ShaperTable* active = nullptr;
+    ShaperTable* fading = nullptr;
+    int fadePosition = 0;
+};
+
+/** Diode solution tables for every rate the drive stage can run at, the host rate times 1, 2,
+    4 and 8. They are fetched in prepareToPlay(), so the audio thread never builds one, and
+    come from SharedResources, so instances at the same rate share them.
+*/
+struct DiodeTableSet
+{
+    static constexpr int numRates = 4;
+    std::array<SharedDiodeTable::Ptr, numRates> tables;
+
+    /** Builds whatever isn't shared yet. Never on the audio thread. */
+    void prepare (SharedResources& resources, double sampleRate)
+    {
+        for (int i = 0; i < numRates; ++i)
+            tables[(size_t) i] = resources.getDiodeTable (sampleRate * (double) (1 << i));
+    }
+};
+
+//==============================================================================
+/*  The JUCE side of the LOWCUT -> TILT -> drive -> TILT -> HIGHCUT -> VOLUME
+    chain for one sample type.
+
+    All of the filter and shaper DSP lives in lemondrive::DriveCore, which has
+    no JUCE dependency (see Core/). The engine is the adapter around it: it
+    reads the parameters or the A/B morph, runs the core's three stages with
+    the oversampler around the drive stage, hands the table shaper to
+    the core as its custom kernel, and looks after metering, idle detection and
+    profiling. In linear-phase CUTMODE it also runs the partitioned
+    convolutions that replace the core's LOWCUT and HIGHCUT, allocated only
+    once that mode is first selected, and with a
+    sidechain as the DYNSOURCE it points the core's envelope follower at it.
+    The drive stage then hears the input late by the LOWCUT convolver's
+    latency, so the sidechain is held back as long; the input follower already
+    reads the convolved signal. DYNCUT has no LOWCUT to move in that mode.
+
+    The processor owns one engine per precision and the host's choice of
+    processBlock overload picks which one runs, so there is no precision switch
+    inside the chain: core, smoothing, oversampling and the shaper kernels are
+    all instantiated for SampleType and use its own SIMD width. Only the meter
+    feed stays float.
+*/
+template <typename SampleType>
+class DriveEngine
+{
+public:
+    using Core = lemondrive::DriveCore<SampleType>;
+
+    /** HIGHCUT at or above this is treated as off. */
+    static constexpr float highCutBypassFrequency = Core::highCutBypassFrequency;
+
+    /** Output level (-120 dB) below which the chain counts as silent. */
+    static constexpr float silenceThreshold = Core::silenceThreshold;
+
+    /** Roughly how long the filters ring after the input stops, until they are below silenceThreshold. */
+    static double getTailLengthSeconds (const ChainSettings& settings) noexcept
+    {
+        return Core::getTailLengthSeconds (settings);
+    }
+
+    DriveEngine (const DriveParameters& p, MeterFeed& feed, LoadProfiler& loadProfiler)
+        : params (p), meterFeed (feed), profiler (loadProfiler)
+    {
+    }
+
+    //==============================================================================
+    void prepare (double sampleRate, int samplesPerBlock, int numChannels, int numSidechainChannels, bool isNonRealtime,
+                  const LinearPhaseState& cutKernels, const DiodeTableSet& diodeTables)
+    {
+        // isBusesLayoutSupported() never lets through more than the core has state for
+        jassert (numChannels <= lemondrive::maxChannels);
+
+        currentSampleRate = sampleRate;
+        tileSize = juce::jmax (1, samplesPerBlock);
+        preparedChannels = numChannels;
+        preparedSidechainChannels = juce::jlimit (0, lemondrive::maxChannels, numSidechainChannels);
+
+        // everything below only ever sees one tile, at most the announced block size, at a time
+        core.prepare (sampleRate, numChannels, getTargets());
+        setDiodeTables (diodeTables);
+        linkBuffer.setSize (1, 2 * (tileSize << maxOversamplingFactor));
+        gainRamps.setSize (2, tileSize);
+        scopePoints.resize ((size_t) (tileSize / MeterFeed::scopeDecimation + 1));
+        scopePhase = 0;
+
+        // the convolvers only take memory while linear phase is selected, sized at the new rate
+        releaseLinearPhase();
+
+        if (isLinearPhaseSelected())
+            prepareLinearPhase();
+
+        // every factor/filter combination is prepared up front so switching OVERSAMPLING never allocates
+        for (int factorIndex = 1; factorIndex <= maxOversamplingFactor; ++factorIndex)
+        {
+            for (int filterIndex = 0; filterIndex < 2; ++filterIndex)
+            {
+                auto filterType = filterIndex == 0 ? Oversampler::filterHalfBandPolyphaseIIR
+                                                   : Oversampler::filterHalfBandFIREquiripple;
+
+                auto& os = oversamplers[(size_t) getOversamplerIndex (factorIndex, filterIndex)];
+                os = std::make_unique<Oversampler> ((size_t) juce::jmax (1, numChannels),
+                                                    (size_t) factorIndex, filterType, true, true);
+                os->initProcessing ((size_t) tileSize);
+            }
+        }
+
+        activeOversampler = -1;
+        updateOversampling (isNonRealtime);
+        setLinearPhase (wantsLinearPhase (cutKernels));
+        reset();
+    }
+
+    /** Frees everything prepare() allocated; process() passes audio through until the next prepare(). */
+    void release()
+    {
+        for (auto& os : oversamplers)
+            os.reset();
+
+        releaseLinearPhase();
+
+        // the processor may let the tables go before this engine is prepared again
+        core.setDiodeTables (nullptr, 0);
+
+        activeOversampler = -1;
+        oversamplingLatency = latencySamples = 0;
+        gainRamps.setSize (0, 0);
+        linkBuffer.setSize (0, 0);
+    }
+
+    bool isPrepared() const noexcept    { return gainRamps.getNumChannels() > 0; }
+
+    /** Sizes the linear-phase convolvers, which a minimum-phase engine goes without. prepare()
+        calls it if CUTMODE is already linear phase, and the processor's timer once it is switched
+        there; never on the audio thread, which only starts using them after this returns.
+    */
+    void prepareLinearPhase()
+    {
+        if (linearPhaseReady.load() || ! isPrepared())
+            return;
+
+        lowCutConvolver.prepare (CutKernel::Type::lowCut, currentSampleRate, preparedChannels);
+        highCutConvolver.prepare (CutKernel::Type::highCut, currentSampleRate, preparedChannels);
+
+        sidechainDelayLength = lowCutConvolver.getLatencySamples();
+        sidechainDelay.setSize (preparedSidechainChannels, juce::jmax (1, sidechainDelayLength));
+        delayedSidechain.setSize (preparedSidechainChannels, tileSize);
+        resetSidechainDelay();
+
+        linearPhaseReady = true;
+    }
+
+    void reset() noexcept
+    {
+        core.reset();
+
+        for (auto& os : oversamplers)
+            if (os != nullptr)
+                os->reset();
+
+        if (linearPhaseReady.load())
+        {
+            lowCutConvolver.reset();
+            highCutConvolver.reset();
+            resetSidechainDelay();
+        }
+
+        idle = false;
+        silentSamples = 0;
+        scopePhase = 0;
+    }
+
+    /** True while the input is silent and the tail has been flushed, so process() only clears. */
+    bool isIdle() const noexcept    { return idle; }
+
+    /** Latency of the oversampler and, in linear-phase mode, the cut filters, as picked by the
+        last process() call.
+    */
+    int getLatencySamples() const noexcept  { return latencySamples; }
+
+    //==============================================================================
+    /** Runs the chain over the buffer. A host block larger than the one announced to
+        prepare() is split into tiles of that size, so nothing is ever longer than what the
+        buffers and oversamplers were sized for. The sidechain has as many samples as the
+        buffer, or no channels if there is none.
+    */
+    void process (juce::AudioBuffer<SampleType>& buffer, int numChannels, const juce::AudioBuffer<SampleType>& sidechain,
+                  bool isNonRealtime, ShaperTableState& tables, LinearPhaseState& cutKernels)
+    {
+        auto numSamples = buffer.getNumSamples();
+
+        jassert (isPrepared());
+
+        if (numSamples == 0 || numChannels == 0 || ! isPrepared())
+            return;
+
+        // Idle fast path: with silent input and the tail already flushed there is nothing to
+        // compute. Clearing the whole buffer also sets its isClear flag, which is as close as
+        // JUCE gets to passing the host's silence flags on.
+        auto targets = getTargets();
+        const auto inputSilent = isInputSilent (buffer, numChannels, targets);
+
+        if (inputSilent && idle)
+        {
+            buffer.clear();
+
+            if (meterFeed.isActive())
+                meterFeed.pushFrame ({});
+
+            return;
+        }
+
+        if (! inputSilent)
+        {
+            if (idle)
+                leaveIdle (targets);
+
+            silentSamples = 0;
+        }
+
+        auto shaperMode = (DriveParameters::ShaperMode) (int) params.shaper->load();
+        auto adaaMode = (DriveParameters::AdaaMode) (int) params.adaa->load();
+
+        BlockContext context { tables, cutKernels };
+        context.useTable = adaaMode == DriveParameters::AdaaMode::off
+                            && shaperMode == DriveParameters::ShaperMode::table && tables.active != nullptr;
+        context.metering = meterFeed.isActive();
+
+        auto& mode = context.mode;
+        mode.sampleAccurate = params.smoothing->load() > 0.5f;
+        mode.linked = params.link->load() > 0.5f;
+
+        // the diode has memory of its own, so ADAA doesn't apply to it
+        if (shaperMode == DriveParameters::ShaperMode::diode)
+            mode.shaper = Core::Shaper::diode;
+        else if (shaperMode == DriveParameters::ShaperMode::diodeTable)
+            mode.shaper = Core::Shaper::diodeTable;
+        else if (adaaMode == DriveParameters::AdaaMode::firstOrder)
+            mode.shaper = Core::Shaper::adaaFirstOrder;
+        else if (adaaMode == DriveParameters::AdaaMode::secondOrder)
+            mode.shaper = Core::Shaper::adaaSecondOrder;
+        else if (context.useTable)
+            mode.shaper = Core::Shaper::custom;
+        else if (shaperMode == DriveParameters::ShaperMode::reference)
+            mode.shaper = Core::Shaper::reference;
+        else
+            mode.shaper = Core::Shaper::fast;
+
+        // the table has pi/(1-curve) * 2/pi built in
+        if (context.useTable)
+            mode.customSlope = (SampleType) 2 / ((SampleType) 1 - (SampleType) tables.active->getCurve());
+
+        // only the nonlinear stage runs at the oversampled rate
+        context.oversampler = updateOversampling (isNonRealtime);
+
+        // the linear-phase cuts take over once kernels for this rate have arrived
+        setLinearPhase (wantsLinearPhase (cutKernels));
+        context.linearPhase = linearPhase;
+
+        // with no sidechain connected the follower falls back to the input
+        core.setDynamics (params.getDynamicsSettings());
+
+        if (params.getDynamicsSource() == DriveParameters::DynamicsSource::sidechain && sidechain.getNumChannels() > 0)
+            context.sidechain = &sidechain;
+
+        // multiband replaces the shaper, at the same rate
+        core.beginBlock (targets, params.getMultibandSettings());
+
+        auto audioBlock = juce::dsp::AudioBlock<SampleType> (buffer).getSubsetChannelBlock (0, (size_t) numChannels);
+
+        for (int start = 0; start < numSamples; start += tileSize)
+        {
+            auto tile = audioBlock.getSubBlock ((size_t) start, (size_t) juce::jmin (tileSize, numSamples - start));
+            context.tileStart = start;
+            processTile (tile, context);
+        }
+
+        if (context.metering)
+        {
+            MeterFrame meterFrame;
+            meterFrame.inputPeak = context.inputLevels.peak;
+            meterFrame.inputRms = context.inputLevels.getRms();
+            meterFrame.outputPeak = context.outputLevels.peak;
+            meterFrame.outputRms = context.outputLevels.getRms();
+
+            auto linearRms = context.driveInputLevels.getRms() * (float) context.smallSignalGain;
+
+            if (meterFrame.outputRms > 0.0f && linearRms > meterFrame.outputRms)
+                meterFrame.saturationDb = juce::Decibels::gainToDecibels (linearRms / meterFrame.outputRms);
+
+            meterFeed.pushFrame (meterFrame);
+        }
+
+        // keep running until the filters have rung out, then stop only once the output agrees
+        if (inputSilent)
+        {
+            silentSamples += numSamples;
+
+            if (silentSamples >= getTailLengthSamples() && isSilent (buffer, numChannels, (SampleType) silenceThreshold))
+                enterIdle();
+        }
+    }
+
+private:
+    using Oversampler = juce::dsp::Oversampling<SampleType>;
+
+    /** Peak and mean square over everything added to it, across channels and tiles. */
+    struct Levels
+    {
+        float peak = 0.0f;
+        double sumOfSquares = 0.0;
+        size_t numValues = 0;
+
+        void add (const juce::dsp::AudioBlock<SampleType>& block, SampleType scale = 1) noexcept
+        {
+            auto blockPeak = (SampleType) 0;
+            auto blockSum = (SampleType) 0;
+
+            for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+            {
+                auto* data = block.getChannelPointer (channel);
+
+                for (size_t i = 0; i < block.getNumSamples(); ++i)
+                {
+                    blockPeak = juce::jmax (blockPeak, std::abs (data[i]));
+                    blockSum += data[i] * data[i];
+                }
+            }
+
+            peak = juce::jmax (peak, (float) (blockPeak * scale));
+            sumOfSquares += (double) (blockSum * scale * scale);
+            numValues += block.getNumChannels() * block.getNumSamples();
+        }
+
+        float getRms() const noexcept
+        {
+            return numValues > 0 ? (float) std::sqrt (sumOfSquares / (double) numValues) : 0.0f;
+        }
+    };
+
+    /** Everything that stays fixed for a host block, plus the meters that span its tiles. */
+    struct BlockContext
+    {
+        ShaperTableState& tables;
+        LinearPhaseState& cutKernels;
+        typename Core::DriveMode mode;
+        bool useTable = false, metering = false, linearPhase = false;
+        Oversampler* oversampler = nullptr;
+        const juce::AudioBuffer<SampleType>* sidechain = nullptr;
+        int tileStart = 0;
+
+        Levels inputLevels, driveInputLevels, outputLevels;
+        SampleType smallSignalGain = 0;
+    };
+
+    /** The core works on plain channel pointers; these are an AudioBlock's, sub-block offset included. */
+    struct ChannelPointers
+    {
+        explicit ChannelPointers (const juce::dsp::AudioBlock<SampleType>& block) noexcept
+            : numChannels (juce::jmin ((int) block.getNumChannels(), lemondrive::maxChannels))
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                data[channel] = block.getChannelPointer ((size_t) channel);
+        }
+
+        SampleType* data[lemondrive::maxChannels];
+        int numChannels;
+    };
+
+    //==============================================================================
+    void processTile (juce::dsp::AudioBlock<SampleType>& tile, BlockContext& context) noexcept
+    {
+        auto numSamples = (int) tile.getNumSamples();
+        auto& tables = context.tables;
+        auto stageStart = profiler.stamp();
+
+        if (context.metering)
+            context.inputLevels.add (tile);
+
+        ChannelPointers channels (tile);
+
+        // the core's own LOWCUT and HIGHCUT are bypassed while these run
+        if (context.linearPhase)
+            lowCutConvolver.process (channels.data, channels.numChannels, numSamples, context.cutKernels.lowCut);
+
+        // the input follower reads the convolved tile, so in linear phase the sidechain is delayed to match
+        if (context.sidechain != nullptr)
+            setSidechainDetector (*context.sidechain, context.tileStart, numSamples, context.linearPhase);
+
+        auto gains = core.processPreDrive (channels.data, channels.numChannels, numSamples,
+                                           gainRamps.getWritePointer (0), gainRamps.getWritePointer (1),
+                                           context.mode, [this] { return getTargets(); });
+
+        // measured after the input ramp, so take it back out to stay in the pre-drive domain
+        if (context.metering)
+            context.driveInputLevels.add (tile, gains.ramped ? (SampleType) 1 / gains.input[numSamples - 1] : (SampleType) 1);
+
+        stageStart = profiler.lap (LoadProfiler::preFilters, stageStart);
+
+        auto shaperBlock = tile;
+        auto* oversampler = context.oversampler;
+
+        if (oversampler != nullptr)
+            shaperBlock = oversampler->processSamplesUp (shaperBlock);
+
+        stageStart = profiler.lap (LoadProfiler::oversampling, stageStart);
+
+        // scope points are picked at the shaper itself, so oversampling latency doesn't skew the trace
+        const auto shaperRateFactor = oversampler != nullptr ? (int) oversampler->getOversamplingFactor() : 1;
+        const auto numScopePoints = context.metering ? juce::jmin ((int) scopePoints.size(),
+                                                                   (numSamples - scopePhase + MeterFeed::scopeDecimation - 1) / MeterFeed::scopeDecimation)
+                                                     : 0;
+
+        auto numShaperSamples = (int) shaperBlock.getNumSamples();
+
+        auto captureScope = [&] (bool input)
+        {
+            auto* data = shaperBlock.getChannelPointer (0);
+
+            for (int i = 0; i < numScopePoints; ++i)
+            {
+                auto value = (float) data[(scopePhase + i * MeterFeed::scopeDecimation) * shaperRateFactor];
+                (input ? scopePoints[(size_t) i].input : scopePoints[(size_t) i].output) = value;
+            }
+        };
+
+        if (context.metering)
+            captureScope (true);
+
+        // the table shaper is the core's custom kernel, crossfading while a new CURVE table comes in
+        auto runTable = [&tables] (SampleType* data, int n, SampleType inScale, SampleType outScale)
+        {
+            if (tables.fading != nullptr)
+                ShaperTable::processCrossfade (*tables.fading, *tables.active, data, n,
+                                               inScale, outScale, tables.fadePosition, ShaperTableState::fadeLength);
+            else
+                tables.active->process (data, n, inScale, outScale);
+        };
+
+        ChannelPointers shaperChannels (shaperBlock);
+        auto* linkScratch = 2 * numShaperSamples <= linkBuffer.getNumSamples() ? linkBuffer.getWritePointer (0) : nullptr;
+
+        core.processDrive (shaperChannels.data, shaperChannels.numChannels, numShaperSamples, gains, context.mode, linkScratch, runTable);
+
+        if (context.metering)
+            captureScope (false);
+
+        if (tables.fading != nullptr)
+            tables.fadePosition += numShaperSamples;
+
+        stageStart = profiler.lap (LoadProfiler::shaper, stageStart);
+
+        if (oversampler != nullptr)
+            oversampler->processSamplesDown (tile);
+
+        stageStart = profiler.lap (LoadProfiler::oversampling, stageStart);
+
+        core.processPostDrive (channels.data, channels.numChannels, gains);
+
+        if (context.linearPhase)
+            highCutConvolver.process (channels.data, channels.numChannels, numSamples, context.cutKernels.highCut);
+
+        stageStart = profiler.lap (LoadProfiler::postFilters, stageStart);
+
+        if (context.metering)
+        {
+            context.outputLevels.add (tile);
+            context.smallSignalGain = core.getSmallSignalGain (gains, context.mode);
+
+            // bring the trace back to pre-drive input and final output levels
+            for (int i = 0; i < numScopePoints; ++i)
+            {
+                auto index = scopePhase + i * MeterFeed::scopeDecimation;
+
+                if (gains.ramped)
+                {
+                    scopePoints[(size_t) i].input /= (float) gains.input[index];
+                    scopePoints[(size_t) i].output *= (float) gains.output[index];
+                }
+            }
+
+            meterFeed.pushScope (scopePoints.data(), numScopePoints);
+            scopePhase = (scopePhase + numScopePoints * MeterFeed::scopeDecimation) - numSamples;
+
+            if (scopePhase < 0 || scopePhase >= MeterFeed::scopeDecimation)
+                scopePhase = 0;
+
+            profiler.lap (LoadProfiler::metering, stageStart);
+        }
+    }
+
+    /** Delayed, the detector is the sidechain as it was the LOWCUT convolver's latency ago. */
+    void setSidechainDetector (const juce::AudioBuffer<SampleType>& sidechain, int start, int numSamples, bool delayed) noexcept
+    {
+        const SampleType* detector[lemondrive::maxChannels];
+        auto numDetectorChannels = juce::jmin (sidechain.getNumChannels(), lemondrive::maxChannels);
+
+        if (! delayed || sidechainDelayLength == 0)
+        {
+            for (int channel = 0; channel < numDetectorChannels; ++channel)
+                detector[channel] = sidechain.getReadPointer (channel, start);
+
+            core.setDetector (detector, numDetectorChannels);
+            return;
+        }
+
+        numDetectorChannels = juce::jmin (numDetectorChannels, sidechainDelay.getNumChannels());
+        auto position = sidechainDelayPosition;
+
+        for (int channel = 0; channel < numDetectorChannels; ++channel)
+        {
+            auto* src = sidechain.getReadPointer (channel, start);
+            auto* line = sidechainDelay.getWritePointer (channel);
+            auto* dest = delayedSidechain.getWritePointer (channel);
+            position = sidechainDelayPosition;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                dest[i] = line[position];
+                line[position] = src[i];
+
+                if (++position == sidechainDelayLength)
+                    position = 0;
+            }
+
+            detector[channel] = dest;
+        }
+
+        sidechainDelayPosition = position;
+        core.setDetector (detector, numDetectorChannels);
+    }
+
+    void resetSidechainDelay() noexcept
+    {
+        sidechainDelay.clear();
+        sidechainDelayPosition = 0;
+    }
+
+    //==============================================================================
+    static bool isSilent (const juce::AudioBuffer<SampleType>& buffer, int numChannels, SampleType threshold) noexcept
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto range = juce::FloatVectorOperations::findMinAndMax (buffer.getReadPointer (channel), buffer.getNumSamples());
+
+            if (range.getStart() < -threshold || range.getEnd() > threshold)
+                return false;
+        }
+
+        return true;
+    }
+
+    /** Input is silent if even the chain's largest small-signal gain keeps it below the threshold. */
+    bool isInputSilent (const juce::AudioBuffer<SampleType>& buffer, int numChannels, const lemondrive::DriveTargets& targets) const noexcept
+    {
+        if (buffer.hasBeenCleared())
+            return true;
+
+        auto gain = core.getMaximumSmallSignalGain (targets);
+
+        // the tilt can lift the highs by up to 6 dB into the shaper
+        return isSilent (buffer, numChannels, (SampleType) silenceThreshold / juce::jmax ((SampleType) 2 * gain, (SampleType) 1.0e-3));
+    }
+
+    int getTailLengthSamples() const noexcept
+    {
+        return (int) std::ceil (core.getTailLengthSeconds() * currentSampleRate) + latencySamples;
+    }
+
+    void enterIdle() noexcept
+    {
+        reset();
+        idle = true;
+    }
+
+    /** State was cleared on the way in, so the first sound starts from rest. Parameters that
+        moved while idle jump straight to their targets instead of gliding from stale values.
+    */
+    void leaveIdle (const lemondrive::DriveTargets& targets) noexcept
+    {
+        idle = false;
+        core.jumpToTargets (targets);
+    }
+
+    //==============================================================================
+    /** The values the smoothers head for: the live parameters, the held set while a
+        whole set is being written, or the A/B blend while both slots are stored.
+        Reading the snapshots never blocks, so this is safe on the audio thread.
+    */
+    lemondrive::DriveTargets getTargets() noexcept
+    {
+        if (params.snapshots != nullptr)
+        {
+            auto& state = params.snapshots->read();
+
+            if (state.isMorphing())
+                return toCoreTargets (ParameterSnapshot::interpolate (state.a, state.b, params.morph->load()));
+
+            if (state.holdSet)
+                return toCoreTargets (state.heldSet);
+        }
+
+        return toCoreTargets (params.getLiveSnapshot());
+    }
+
+    static lemondrive::DriveTargets toCoreTargets (const ParameterSnapshot& snapshot) noexcept
+    {
+        lemondrive::DriveTargets targets;
+        targets.drive = snapshot[ParameterSnapshot::drive];
+        targets.range = snapshot[ParameterSnapshot::range];
+        targets.volume = snapshot[ParameterSnapshot::volume];
+        targets.lowCut = snapshot[ParameterSnapshot::lowCut];
+        targets.highCut = snapshot[ParameterSnapshot::highCut];
+        targets.curve = snapshot[ParameterSnapshot::curve];
+        targets.tilt = snapshot[ParameterSnapshot::tilt];
+        return targets;
+    }
+
+    void setDiodeTables (const DiodeTableSet& diodeTables) noexcept
+    {
+        const lemondrive::DiodeTable* tables[DiodeTableSet::numRates];
+
+        for (int i = 0; i < DiodeTableSet::numRates; ++i)
+            tables[i] = diodeTables.tables[(size_t) i].get();
+
+        core.setDiodeTables (tables, DiodeTableSet::numRates);
+    }
+
+    //==============================================================================
+    // OVERSAMPLING choice index n means 2^n, indexed as [factor - 1][OSFILTER]
+    static constexpr int maxOversamplingFactor = 3;
+    static_assert (DiodeTableSet::numRates == maxOversamplingFactor + 1, "one diode table per oversampling factor");
+    static int getOversamplerIndex (int factorIndex, int filterIndex) noexcept { return (factorIndex - 1) * 2 + filterIndex; }
+
+    Oversampler* updateOversampling (bool isNonRealtime) noexcept
+    {
+        auto factorIndex = (int) params.oversampling->load();
+        auto filterIndex = (int) params.osFilter->load();
+
+        // offline bounces don't care about CPU, so they can always use the highest factor
+        if (isNonRealtime && params.osOffline->load() > 0.5f)
+            factorIndex = maxOversamplingFactor;
+
+        auto index = factorIndex > 0 ? getOversamplerIndex (factorIndex, filterIndex) : -1;
+        auto* oversampler = index >= 0 ? oversamplers[(size_t) index].get() : nullptr;
+
+        if (index != activeOversampler)
+        {
+            activeOversampler = index;
+
+            // the ADAA history belongs to the previous sample rate
+            core.resetShaper();
+
+            if (oversampler != nullptr)
+            {
+                oversampler->reset();
+                oversamplingLatency = juce::roundToInt (oversampler->getLatencyInSamples());
+            }
+            else
+            {
+                oversamplingLatency = 0;
+            }
+        }
+
+        core.setOversamplingFactor (oversampler != nullptr ? (int) oversampler->getOversamplingFactor() : 1);
+        return oversampler;
+    }
+
+    //==============================================================================
+    bool isLinearPhaseSelected() const noexcept
+    {
+        return params.cutMode != nullptr
+                && (DriveParameters::CutMode) (int) params.cutMode->load() == DriveParameters::CutMode::linearPhase;
+    }
+
+    bool wantsLinearPhase (const LinearPhaseState& cutKernels) const noexcept
+    {
+        return isLinearPhaseSelected()
+                && linearPhaseReady.load()
+                && lowCutConvolver.canUse (cutKernels.lowCut.active)
+                && highCutConvolver.canUse (cutKernels.highCut.active);
+    }
+
+    /** Only while no audio is being processed. */
+    void releaseLinearPhase()
+    {
+        linearPhaseReady = false;
+        lowCutConvolver.release();
+        highCutConvolver.release();
+        sidechainDelay.setSize (0, 0);
+        delayedSidechain.setSize (0, 0);
+        sidechainDelayLength = 0;
+    }
+
+    int getLinearPhaseLatency() const noexcept
+    {
+        return lowCutConvolver.getLatencySamples() + highCutConvolver.getLatencySamples();
+    }
+
+    /** Switching either way starts the incoming filters from clear state, and moves the latency. */
+    void setLinearPhase (bool shouldBeLinear) noexcept
+    {
+        if (shouldBeLinear != linearPhase)
+        {
+            linearPhase = shouldBeLinear;
+            lowCutConvolver.reset();
+            highCutConvolver.reset();
+            resetSidechainDelay();
+            core.setCutFiltersBypassed (linearPhase);
+        }
+
+        latencySamples = oversamplingLatency + (linearPhase ? getLinearPhaseLatency() : 0);
+    }
+
+    //==============================================================================
+    const DriveParameters& params;
+    MeterFeed& meterFeed;
+    LoadProfiler& profiler;
+
+    Core core;
+    juce::AudioBuffer<SampleType> gainRamps;    // 0: shaper input gain, 1: output gain
+    juce::AudioBuffer<SampleType> linkBuffer;   // linked detector, then linked gain
+
+    std::vector<ScopePoint> scopePoints;
+    int scopePhase = 0;
+
+    std::array<std::unique_ptr<Oversampler>, maxOversamplingFactor * 2> oversamplers;
+    int activeOversampler = -1;
+    int oversamplingLatency = 0, latencySamples = 0;
+
+    PartitionedConvolver lowCutConvolver, highCutConvolver;
+    std::atomic<bool> linearPhaseReady { false };   // set once prepareLinearPhase() is done
+    bool linearPhase = false;
+
+    juce::AudioBuffer<SampleType> sidechainDelay;       // ring of the last sidechainDelayLength samples
+    juce::AudioBuffer<SampleType> delayedSidechain;     // one tile of its output, for the detector
+    int sidechainDelayLength = 0, sidechainDelayPosition = 0;
+
+    int tileSize = 0, preparedChannels = 0, preparedSidechainChannels = 0;
+
+    double currentSampleRate = 44100.0;
+    bool idle = false;
+    int silentSamples = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (DriveEngine)
+};
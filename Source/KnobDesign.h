@@ -10,6 +10,7 @@
 
 #pragma once
 #include <JuceHeader.h>
+#include "SharedResources.h"
 using namespace juce;
 
 class KnobDesign : public juce::LookAndFeel_V4
@@ -28,6 +29,15 @@ public:
     }
     void drawRotarySlider (juce::Graphics& g, int x, int y, int width, int height, float sliderPos,
                             const float rotaryStartAngle, const float rotaryEndAngle, juce::Slider& slider) override {
+        // every frame comes from the filmstrip; drawKnobFrame only runs the first time a position is shown
+        resources->getKnobFilmstrip().draw (g, { x, y, width, height }, sliderPos, rotaryStartAngle, rotaryEndAngle,
+                        [this, rotaryStartAngle, rotaryEndAngle] (juce::Graphics& fg, int w, int h, float pos)
+                        {
+                            drawKnobFrame (fg, 0, 0, w, h, pos, rotaryStartAngle, rotaryEndAngle);
+                        });
+    }
+    void drawKnobFrame (juce::Graphics& g, int x, int y, int width, int height, float sliderPos,
+                        const float rotaryStartAngle, const float rotaryEndAngle) {
          auto radius = (float) juce::jmin (width / 2, height / 2) - 4.0f;
          auto centreX = (float) x + (float) width  * 0.5f;
          auto centreY = (float) y + (float) height * 0.5f;
@@ -39,8 +49,9 @@ public:
          // fill
      
          
-        juce::Image fillImg = juce::ImageCache::getFromMemory(BinaryData::KnobImg_png,BinaryData::KnobImg_pngSize);
-        g.drawImageWithin(fillImg, rx, ry, rw, rw, juce::RectanglePlacement::stretchToFit);
+        if (knobImage.isNull())
+            knobImage = resources->getImage(BinaryData::KnobImg_png,BinaryData::KnobImg_pngSize);
+        g.drawImageWithin(knobImage, rx, ry, rw, rw, juce::RectanglePlacement::stretchToFit);
         g.fillEllipse (rx, ry, rw, rw);
          // outline
          g.setColour (juce::Colours::skyblue);
@@ -68,4 +79,7 @@ public:
         return l;
     }
 
+private:
+    SharedResources::Pointer resources;
+    juce::Image knobImage;
 };
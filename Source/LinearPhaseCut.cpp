@@ -0,0 +1,345 @@
+/*
+  ==============================================================================
+
+    LinearPhaseCut.cpp
+    Created: 23 Oct 2026 11:02:31am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseCut.h"
+
+void PartitionedConvolver::prepare (CutKernel::Type newType, double newSampleRate, int numChannels)
+{
+    type = newType;
+    sampleRate = newSampleRate;
+    preparedChannels = juce::jmax (1, numChannels);
+    numPartitions = CutKernel::getKernelLength (type, sampleRate) / partitionSize;
+    latencySamples = CutKernel::getLatencySamples (type, sampleRate);
+
+    inputBlocks.setSize (preparedChannels, 2 * partitionSize);
+    outputBlocks.setSize (preparedChannels, 2 * partitionSize);
+    spectra.resize ((size_t) numPartitions * (size_t) preparedChannels * numBins);
+    activeSums.resize ((size_t) preparedChannels * numBins);
+    fadingSums.resize ((size_t) preparedChannels * numBins);
+    fftBuffer.resize ((size_t) partitionSize * 4);
+
+    reset();
+}
+
+void PartitionedConvolver::release()
+{
+    inputBlocks.setSize (0, 0);
+    outputBlocks.setSize (0, 0);
+
+    for (auto* buffer : { &spectra, &activeSums, &fadingSums })
+        std::vector<std::complex<float>>().swap (*buffer);
+
+    std::vector<float>().swap (fftBuffer);
+    preparedChannels = numPartitions = latencySamples = 0;
+}
+
+void PartitionedConvolver::reset() noexcept
+{
+    inputBlocks.clear();
+    outputBlocks.clear();
+    std::fill (spectra.begin(), spectra.end(), std::complex<float>());
+    fifoPosition = 0;
+    newestSlot = 0;
+}
+
+bool PartitionedConvolver::canUse (const CutKernel* kernel) const noexcept
+{
+    return kernel != nullptr && kernel->getType() == type && kernel->getSampleRate() == sampleRate
+            && kernel->getNumPartitions() == numPartitions;
+}
+
+template <typename SampleType>
+void PartitionedConvolver::process (SampleType* const* channels, int numChannels, int numSamples, CutKernelState& kernels) noexcept
+{
+    numChannels = juce::jmin (numChannels, preparedChannels);
+
+    // a block goes in and the one computed from the previous block comes out, sample for sample
+    for (int start = 0; start < numSamples;)
+    {
+        auto length = juce::jmin (numSamples - start, partitionSize - fifoPosition);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = channels[channel] + start;
+            auto* in = inputBlocks.getWritePointer (channel, partitionSize + fifoPosition);
+            auto* out = outputBlocks.getReadPointer (channel, fifoPosition);
+
+            for (int i = 0; i < length; ++i)
+            {
+                in[i] = (float) data[i];
+                data[i] = (SampleType) out[i];
+            }
+        }
+
+        fifoPosition += length;
+        start += length;
+
+        if (fifoPosition == partitionSize)
+        {
+            processPartition (kernels);
+            fifoPosition = 0;
+        }
+    }
+}
+
+void PartitionedConvolver::processPartition (CutKernelState& kernels) noexcept
+{
+    newestSlot = (newestSlot + 1) % numPartitions;
+
+    // the last two blocks of input, transformed into the newest slot of the delay line
+    for (int channel = 0; channel < preparedChannels; ++channel)
+    {
+        auto* block = inputBlocks.getWritePointer (channel);
+
+        std::copy_n (block, 2 * partitionSize, fftBuffer.begin());
+        std::fill (fftBuffer.begin() + 2 * partitionSize, fftBuffer.end(), 0.0f);
+        fft.performRealOnlyForwardTransform (fftBuffer.data(), true);
+
+        std::copy_n (reinterpret_cast<const std::complex<float>*> (fftBuffer.data()), numBins, getSpectrum (newestSlot, channel));
+        std::copy_n (block + partitionSize, partitionSize, block);
+    }
+
+    // no usable kernel is never expected, but if it happens the output is silence rather than stale
+    if (canUse (kernels.active))
+        accumulate (*kernels.active, activeSums.data());
+    else
+        std::fill (activeSums.begin(), activeSums.end(), std::complex<float>());
+
+    for (int channel = 0; channel < preparedChannels; ++channel)
+        inverseTransform (activeSums.data() + (size_t) channel * numBins, outputBlocks.getWritePointer (channel));
+
+    if (kernels.fading == nullptr)
+        return;
+
+    if (kernels.fadePosition < CutKernelState::fadeLength && canUse (kernels.fading))
+    {
+        accumulate (*kernels.fading, fadingSums.data());
+
+        const auto step = 1.0f / (float) CutKernelState::fadeLength;
+
+        for (int channel = 0; channel < preparedChannels; ++channel)
+        {
+            auto* out = outputBlocks.getWritePointer (channel);
+            auto* faded = outputBlocks.getWritePointer (channel, partitionSize);
+            inverseTransform (fadingSums.data() + (size_t) channel * numBins, faded);
+
+            for (int i = 0; i < partitionSize; ++i)
+            {
+                auto alpha = juce::jmin (1.0f, (float) (kernels.fadePosition + i) * step);
+                out[i] = faded[i] + alpha * (out[i] - faded[i]);
+            }
+        }
+    }
+
+    kernels.fadePosition += partitionSize;
+}
+
+void PartitionedConvolver::accumulate (const CutKernel& kernel, std::complex<float>* sums) noexcept
+{
+    std::fill (sums, sums + (size_t) preparedChannels * numBins, std::complex<float>());
+
+    // kernel partition p meets the input from p blocks ago; each partition is loaded once for all channels
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        auto* h = reinterpret_cast<const float*> (kernel.getPartition (partition));
+        auto slot = (newestSlot - partition + numPartitions) % numPartitions;
+
+        for (int channel = 0; channel < preparedChannels; ++channel)
+        {
+            auto* x = reinterpret_cast<const float*> (getSpectrum (slot, channel));
+            auto* sum = reinterpret_cast<float*> (sums + (size_t) channel * numBins);
+
+            for (int bin = 0; bin < 2 * numBins; bin += 2)
+            {
+                sum[bin]     += x[bin] * h[bin]     - x[bin + 1] * h[bin + 1];
+                sum[bin + 1] += x[bin] * h[bin + 1] + x[bin + 1] * h[bin];
+            }
+        }
+    }
+}
+
+void PartitionedConvolver::inverseTransform (const std::complex<float>* sum, float* output) noexcept
+{
+    auto* bins = reinterpret_cast<std::complex<float>*> (fftBuffer.data());
+    const auto fftSize = 2 * partitionSize;
+
+    // not every FFT backend fills in the negative frequencies itself, so mirror them here
+    std::copy_n (sum, numBins, bins);
+
+    for (int k = numBins; k < fftSize; ++k)
+        bins[k] = std::conj (bins[fftSize - k]);
+
+    fft.performRealOnlyInverseTransform (fftBuffer.data());
+
+    // overlap-save: only the second half is free of wrap-around
+    std::copy_n (fftBuffer.begin() + partitionSize, partitionSize, output);
+}
+
+template void PartitionedConvolver::process (float* const*, int, int, CutKernelState&) noexcept;
+template void PartitionedConvolver::process (double* const*, int, int, CutKernelState&) noexcept;
+
+//==============================================================================
+CutKernelDesigner::~CutKernelDesigner()
+{
+    // waits for a build of ours that is under way; the worker itself belongs to every instance
+    if (worker != nullptr)
+        worker->removeJob (&buildJob, true, 4000);
+}
+
+void CutKernelDesigner::request (float lowCut, float highCut, double sampleRate)
+{
+    {
+        const juce::ScopedLock sl (requestLock);
+        requested = { lowCut, highCut, sampleRate };
+    }
+
+    if (lowCutExchange.isPending (lowCut, sampleRate) && highCutExchange.isPending (highCut, sampleRate))
+        return;
+
+    if (worker == nullptr)
+        worker = &sharedResources->getWorkerPool();
+
+    // a queued job reads the latest request when it runs; if ours already read an older one, it
+    // isn't queued twice now, and the timer's next request() queues it again once it is done
+    if (! worker->contains (&buildJob))
+        worker->addJob (&buildJob, false);
+}
+
+void CutKernelDesigner::prepare (float lowCut, float highCut, double sampleRate, LinearPhaseState& state)
+{
+    {
+        const juce::ScopedLock sl (requestLock);
+        requested = { lowCut, highCut, sampleRate };
+    }
+
+    build();
+
+    // start from the new kernels, with no fade from whatever ran at the previous rate
+    lowCutExchange.clear (state.lowCut);
+    highCutExchange.clear (state.highCut);
+    update (state);
+}
+
+void CutKernelDesigner::release (LinearPhaseState& state)
+{
+    // a build under way finishes first, and one still queued finds nothing to do
+    const juce::ScopedLock sl (buildLock);
+
+    {
+        const juce::ScopedLock rl (requestLock);
+        requested = {};
+    }
+
+    lowCutExchange.release (state.lowCut);
+    highCutExchange.release (state.highCut);
+}
+
+void CutKernelDesigner::update (LinearPhaseState& state) noexcept
+{
+    lowCutExchange.update (state.lowCut);
+    highCutExchange.update (state.highCut);
+}
+
+void CutKernelDesigner::build()
+{
+    const juce::ScopedLock sl (buildLock);
+
+    Request next;
+
+    {
+        const juce::ScopedLock rl (requestLock);
+        next = requested;
+    }
+
+    if (next.sampleRate <= 0.0)
+        return;
+
+    if (! lowCutExchange.isPending (next.lowCut, next.sampleRate))
+        lowCutExchange.publish (sharedResources->getCutKernel (CutKernel::Type::lowCut, next.lowCut, next.sampleRate));
+
+    if (! highCutExchange.isPending (next.highCut, next.sampleRate))
+        highCutExchange.publish (sharedResources->getCutKernel (CutKernel::Type::highCut, next.highCut, next.sampleRate));
+}
+
+//==============================================================================
+void CutKernelDesigner::Exchange::publish (CutKernel::Ptr kernel)
+{
+    const juce::ScopedLock sl (lock);
+
+    retained.addIfNotAlreadyThere (kernel.get());
+    pending = kernel.get();
+
+    // drop whatever the audio thread can no longer reach
+    for (int i = retained.size(); --i >= 0;)
+    {
+        auto* k = retained.getObjectPointerUnchecked (i);
+
+        if (k != pending.load() && k != activeInUse.load() && k != fadingInUse.load())
+            retained.remove (i);
+    }
+}
+
+void CutKernelDesigner::Exchange::update (CutKernelState& state) noexcept
+{
+    if (state.fading != nullptr)
+    {
+        if (state.fadePosition < CutKernelState::fadeLength)
+            return;
+
+        state.fading = nullptr;
+        fadingInUse = nullptr;
+    }
+
+    auto* latest = pending.load();
+
+    if (latest == state.active)
+        return;
+
+    // advertise both kernels before touching them, then check the new one wasn't replaced meanwhile
+    fadingInUse = state.active;
+    activeInUse = latest;
+
+    if (pending.load() != latest)
+    {
+        activeInUse = state.active;
+        return;
+    }
+
+    state.fading = state.active;
+    state.active = latest;
+    state.fadePosition = 0;
+}
+
+void CutKernelDesigner::Exchange::clear (CutKernelState& state)
+{
+    const juce::ScopedLock sl (lock);
+
+    state = {};
+    activeInUse = nullptr;
+    fadingInUse = nullptr;
+}
+
+void CutKernelDesigner::Exchange::release (CutKernelState& state)
+{
+    const juce::ScopedLock sl (lock);
+
+    clear (state);
+    pending = nullptr;
+    retained.clear();
+}
+
+bool CutKernelDesigner::Exchange::isPending (float cutoff, double sampleRate) const noexcept
+{
+    // under the lock, so the pending kernel can't be released while it is looked at
+    const juce::ScopedLock sl (lock);
+
+    auto* kernel = pending.load();
+    return kernel != nullptr && kernel->getCutoff() == cutoff && kernel->getSampleRate() == sampleRate;
+}
@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+    LinearPhaseCut.h
+    Created: 23 Oct 2026 11:02:31am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "CutKernel.h"
+#include "SharedResources.h"
+
+/** The audio thread's side of one filter's kernel hand-off, like ShaperTableState: the
+    kernel in use and, while a cutoff change is being faded in, the one it fades away from.
+*/
+struct CutKernelState
+{
+    static constexpr int fadeLength = 4 * CutKernel::partitionSize;
+
+    CutKernel* active = nullptr;
+    CutKernel* fading = nullptr;
+    int fadePosition = 0;
+};
+
+/** Both linear-phase filters' kernels, owned by the processor and passed to the engine per block. */
+struct LinearPhaseState
+{
+    CutKernelState lowCut, highCut;
+};
+
+//==============================================================================
+/*  Uniformly partitioned overlap-save convolution of every channel with one CutKernel.
+
+    Input is collected in partitionSize blocks; each full block is transformed
+    once per channel into a frequency-domain delay line, and the output block
+    is the sum over partitions of delayed input spectrum times kernel
+    partition. The sum runs partition by partition across all channels, so
+    each kernel partition is read once per block however many channels there
+    are. While a new kernel fades in, both kernels are applied to the same
+    spectra and their outputs crossfaded.
+
+    The FFT is single precision, like juce::dsp::Convolution, so the double
+    engine's linear-phase filters have a float noise floor.
+*/
+class PartitionedConvolver
+{
+public:
+    PartitionedConvolver() = default;
+
+    /** Sizes everything for kernels of this type at this rate, and clears. Allocates. */
+    void prepare (CutKernel::Type type, double sampleRate, int numChannels);
+
+    void release();
+    void reset() noexcept;
+
+    /** Delay through the filter, the same for every kernel this was prepared for. */
+    int getLatencySamples() const noexcept  { return latencySamples; }
+
+    /** True if the kernel was built for the type and rate this was prepared for. */
+    bool canUse (const CutKernel* kernel) const noexcept;
+
+    /** Filters the channels in place, delayed by getLatencySamples(), and moves the crossfade on. */
+    template <typename SampleType>
+    void process (SampleType* const* channels, int numChannels, int numSamples, CutKernelState& kernels) noexcept;
+
+private:
+    static constexpr int partitionSize = CutKernel::partitionSize;
+    static constexpr int numBins = CutKernel::numBins;
+
+    void processPartition (CutKernelState& kernels) noexcept;
+    void accumulate (const CutKernel& kernel, std::complex<float>* sums) noexcept;
+    void inverseTransform (const std::complex<float>* sum, float* output) noexcept;
+
+    std::complex<float>* getSpectrum (int slot, int channel) noexcept
+    {
+        return spectra.data() + ((size_t) slot * (size_t) preparedChannels + (size_t) channel) * numBins;
+    }
+
+    juce::dsp::FFT fft { CutKernel::partitionOrder + 1 };
+    CutKernel::Type type = CutKernel::Type::lowCut;
+    double sampleRate = 0.0;
+    int preparedChannels = 0, numPartitions = 0, latencySamples = 0;
+
+    juce::AudioBuffer<float> inputBlocks;   // per channel: previous block, then the one being filled
+    juce::AudioBuffer<float> outputBlocks;  // per channel: the block being read out, then the fading kernel's
+    std::vector<std::complex<float>> spectra;               // delay line, [slot][channel][bin]
+    std::vector<std::complex<float>> activeSums, fadingSums; // [channel][bin]
+    std::vector<float> fftBuffer;
+    int fifoPosition = 0, newestSlot = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (PartitionedConvolver)
+};
+
+//==============================================================================
+/*  Builds the LOWCUT and HIGHCUT kernels in the background and hands them to
+    the audio thread.
+
+    request() only records the cutoffs and queues a build on the worker thread
+    of SharedResources, so it can be called from the processor's timer as often
+    as it likes. Every instance shares that one thread, and it is only started
+    by the first request. Kernels come from SharedResources too, so instances at
+    the same cutoffs and rate share them. The hand-off follows the shaper
+    tables: the worker publishes a pending kernel, the audio thread advertises
+    what it still reads, and a kernel is only let go once it is neither pending
+    nor in use.
+*/
+class CutKernelDesigner
+{
+public:
+    CutKernelDesigner() = default;
+    ~CutKernelDesigner();
+
+    /** Asks for kernels at these cutoffs and returns at once. Never on the audio thread. */
+    void request (float lowCut, float highCut, double sampleRate);
+
+    /** Builds the kernels on the calling thread and starts the audio thread's state from
+        them, for prepareToPlay. Only while no audio is being processed.
+    */
+    void prepare (float lowCut, float highCut, double sampleRate, LinearPhaseState& state);
+
+    /** Lets every kernel go and clears the audio thread's state, for prepareToPlay while
+        linear phase is off. Only while no audio is being processed.
+    */
+    void release (LinearPhaseState& state);
+
+    /** Audio thread, before each block: takes newly built kernels once earlier fades are done. */
+    void update (LinearPhaseState& state) noexcept;
+
+private:
+    struct Request
+    {
+        float lowCut = 0.0f, highCut = 0.0f;
+        double sampleRate = 0.0;
+    };
+
+    /** One filter's pending kernel and the kernels the audio thread may still be reading. */
+    struct Exchange
+    {
+        void publish (CutKernel::Ptr kernel);
+        void update (CutKernelState& state) noexcept;
+        void clear (CutKernelState& state);
+        void release (CutKernelState& state);
+        bool isPending (float cutoff, double sampleRate) const noexcept;
+
+        juce::CriticalSection lock;
+        juce::ReferenceCountedArray<CutKernel> retained;
+        std::atomic<CutKernel*> pending { nullptr };
+        std::atomic<CutKernel*> activeInUse { nullptr }, fadingInUse { nullptr };
+    };
+
+    /** Builds whatever was requested last, on the worker thread. */
+    struct BuildJob : public juce::ThreadPoolJob
+    {
+        explicit BuildJob (CutKernelDesigner& d) : juce::ThreadPoolJob ("LemonDrive cut kernels"), designer (d) {}
+
+        JobStatus runJob() override
+        {
+            designer.build();
+            return jobHasFinished;
+        }
+
+        CutKernelDesigner& designer;
+    };
+
+    void build();
+
+    SharedResources::Pointer sharedResources;
+    juce::CriticalSection requestLock, buildLock;
+    Request requested;
+    Exchange lowCutExchange, highCutExchange;
+
+    BuildJob buildJob { *this };
+    juce::ThreadPool* worker = nullptr;     // set by the first request()
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CutKernelDesigner)
+};
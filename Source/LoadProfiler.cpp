@@ -0,0 +1,223 @@
+/*
+  ==============================================================================
+
+    LoadProfiler.cpp
+    Created: 21 Oct 2026 2:14:48pm
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#include "LoadProfiler.h"
+
+const char* LoadProfiler::getStageName (int stage) noexcept
+{
+    static const char* const names[] { "pre-filters", "oversampling", "shaper", "post-filters", "metering" };
+    static_assert (juce::numElementsInArray (names) == numStages, "every stage needs a name");
+
+    return juce::isPositiveAndBelow (stage, (int) numStages) ? names[stage] : "";
+}
+
+void LoadProfiler::prepare (double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+    loadMeasurer.reset (newSampleRate, maximumBlockSize);
+    overrunBase = 0;
+}
+
+void LoadProfiler::clear() noexcept
+{
+    blocks = 0;
+    denormalBlocks = 0;
+    allocations = 0;
+    overrunBase = loadMeasurer.getXRunCount();
+    peakProportion = 0.0;
+
+    for (auto& sum : stageProportionSums)
+        sum = 0.0;
+
+    blockHistogram.clear();
+
+    for (auto& histogram : stageHistograms)
+        histogram.clear();
+}
+
+//==============================================================================
+void LoadProfiler::beginBlock (int numSamples) noexcept
+{
+    blockActive = true;
+    blockSamples = numSamples;
+    currentBlockProfiler = this;
+
+    for (auto& cycles : stageCycles)
+        cycles = 0;
+
+    clearFloatingPointFlags();
+    blockStartTicks = juce::Time::getHighResolutionTicks();
+    blockStartCycles = readCycleCounter();
+}
+
+void LoadProfiler::endBlock() noexcept
+{
+    auto cycles = (double) (readCycleCounter() - blockStartCycles);
+    auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - blockStartTicks);
+
+    currentBlockProfiler = nullptr;
+    blockActive = false;
+
+    if (readFloatingPointFlags())
+        denormalBlocks.fetch_add (1, std::memory_order_relaxed);
+
+    if (blockSamples <= 0 || sampleRate <= 0.0)
+        return;
+
+    loadMeasurer.registerRenderTime (seconds * 1000.0, blockSamples);
+
+    auto deadline = (double) blockSamples / sampleRate;
+    auto proportion = seconds / deadline;
+
+    blocks.fetch_add (1, std::memory_order_relaxed);
+    blockHistogram.add (proportion);
+
+    if (proportion > peakProportion.load (std::memory_order_relaxed))
+        peakProportion.store (proportion, std::memory_order_relaxed);
+
+    // the counter's rate is taken from the blocks themselves, averaged over everything so far
+    calibrationCycles += cycles;
+    calibrationSeconds += seconds;
+
+    if (calibrationCycles <= 0.0 || calibrationSeconds <= 0.0)
+        return;
+
+    auto secondsPerCycle = calibrationSeconds / calibrationCycles;
+
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        auto stageProportion = (double) stageCycles[stage] * secondsPerCycle / deadline;
+        auto& sum = stageProportionSums[stage];
+
+        stageHistograms[stage].add (stageProportion);
+        sum.store (sum.load (std::memory_order_relaxed) + stageProportion, std::memory_order_relaxed);
+    }
+}
+
+//==============================================================================
+// x86 MXCSR: DE (bit 1) and UE (bit 4); AArch64 FPSR: UFC (bit 3) and IDC (bit 7). Both are
+// sticky, so clearing them at the start of a block and reading them at the end covers the block.
+void LoadProfiler::clearFloatingPointFlags() noexcept
+{
+   #if JUCE_INTEL
+    _mm_setcsr (_mm_getcsr() & ~0x3fu);
+   #elif JUCE_ARM && defined (__aarch64__) && (JUCE_GCC || JUCE_CLANG)
+    juce::uint64 fpsr;
+    asm volatile ("mrs %0, fpsr" : "=r" (fpsr));
+    asm volatile ("msr fpsr, %0" : : "r" (fpsr & ~(juce::uint64) 0x9f));
+   #endif
+}
+
+bool LoadProfiler::readFloatingPointFlags() noexcept
+{
+   #if JUCE_INTEL
+    return (_mm_getcsr() & 0x12u) != 0;
+   #elif JUCE_ARM && defined (__aarch64__) && (JUCE_GCC || JUCE_CLANG)
+    juce::uint64 fpsr;
+    asm volatile ("mrs %0, fpsr" : "=r" (fpsr));
+    return (fpsr & 0x88) != 0;
+   #else
+    return false;
+   #endif
+}
+
+//==============================================================================
+LoadProfiler::Report LoadProfiler::getReport() const
+{
+    Report report;
+    report.blocks = blocks.load (std::memory_order_relaxed);
+    report.overruns = juce::jmax ((juce::int64) 0, (juce::int64) loadMeasurer.getXRunCount() - overrunBase.load());
+    report.denormalBlocks = denormalBlocks.load (std::memory_order_relaxed);
+    report.allocations = allocations.load (std::memory_order_relaxed);
+    report.averageLoad = loadMeasurer.getLoadAsProportion();
+    report.peakProportion = peakProportion.load (std::memory_order_relaxed);
+
+    for (int bin = 0; bin < numBins; ++bin)
+        report.blockHistogram[bin] = blockHistogram.getCount (bin);
+
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        report.meanStageProportion[stage] = report.blocks > 0 ? stageProportionSums[stage].load() / (double) report.blocks : 0.0;
+
+        for (int bin = 0; bin < numBins; ++bin)
+            report.stageHistograms[stage][bin] = stageHistograms[stage].getCount (bin);
+    }
+
+    return report;
+}
+
+bool LoadProfiler::writeReport (const juce::File& file) const
+{
+    return file.replaceWithText (getReport().toString());
+}
+
+juce::String LoadProfiler::Report::toString() const
+{
+    auto percent = [] (double proportion) { return juce::String (proportion * 100.0, 2) + " %"; };
+
+    juce::String text;
+    text << "LemonDrive load profile, " << juce::Time::getCurrentTime().toString (true, true) << juce::newLine
+         << juce::newLine
+         << "blocks            " << blocks << juce::newLine
+         << "deadline overruns " << overruns << juce::newLine
+         << "denormal blocks   " << denormalBlocks << juce::newLine
+         << "allocations       " << allocations << juce::newLine
+         << "average load      " << percent (averageLoad) << juce::newLine
+         << "peak block        " << percent (peakProportion) << juce::newLine
+         << juce::newLine
+         << "mean share of the deadline per stage" << juce::newLine;
+
+    for (int stage = 0; stage < numStages; ++stage)
+        text << "  " << juce::String (getStageName (stage)).paddedRight (' ', 16) << percent (meanStageProportion[stage]) << juce::newLine;
+
+    text << juce::newLine << "histogram, blocks per bin (% of deadline)" << juce::newLine << "bin       block";
+
+    for (int stage = 0; stage < numStages; ++stage)
+        text << "\t" << getStageName (stage);
+
+    text << juce::newLine;
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        auto low = juce::String (bin * binWidth * 100.0, 1);
+        text << (bin == numBins - 1 ? low + "+" : low + "-" + juce::String ((bin + 1) * binWidth * 100.0, 1)).paddedRight (' ', 10)
+             << (int) blockHistogram[bin];
+
+        for (int stage = 0; stage < numStages; ++stage)
+            text << "\t" << (int) stageHistograms[stage][bin];
+
+        text << juce::newLine;
+    }
+
+    return text;
+}
+
+//==============================================================================
+// Counting allocations means replacing operator new, so it is opt-in per target. The plugin
+// turns it on in its Debug configuration only: a released plugin shares the host's process,
+// whose allocator it must not replace. The console apps that compile these sources bring
+// their own hooks.
+#if LEMONDRIVE_PROFILING && LEMONDRIVE_PROFILE_ALLOCATIONS
+void* operator new (std::size_t size)
+{
+    LoadProfiler::noteAllocation();
+
+    if (auto* p = std::malloc (size == 0 ? 1 : size))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)                 { return operator new (size); }
+void operator delete (void* p) noexcept                 { std::free (p); }
+void operator delete[] (void* p) noexcept               { std::free (p); }
+void operator delete (void* p, std::size_t) noexcept    { std::free (p); }
+void operator delete[] (void* p, std::size_t) noexcept  { std::free (p); }
+#endif
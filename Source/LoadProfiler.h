@@ -0,0 +1,228 @@
+/*
+  ==============================================================================
+
+    LoadProfiler.h
+    Created: 21 Oct 2026 2:14:48pm
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+// Set to 0 to compile the instrumentation out altogether.
+#ifndef LEMONDRIVE_PROFILING
+ #define LEMONDRIVE_PROFILING 1
+#endif
+
+/*  Realtime load instrumentation for processBlock.
+
+    Every block is timed against its deadline (numSamples / sampleRate) and fed
+    to a juce::AudioProcessLoadMeasurer, which provides the average load and
+    counts overruns. On top of that the engine laps a cycle counter at the
+    boundaries between its stages, and each stage's share of the deadline goes
+    into its own histogram. Cycles are converted to seconds with a rate
+    calibrated from the block timings, so no startup measurement is needed.
+
+    A block is also flagged when the FPU's underflow or denormal flags were
+    raised during it (i.e. something was flushed to zero), and, in builds with
+    LEMONDRIVE_PROFILE_ALLOCATIONS (the plugin's Debug configuration), every
+    heap allocation made from inside the block is counted.
+
+    The audio thread is the only writer. Histograms and counters are relaxed
+    atomics, so the editor can read them and clear() can reset them from any
+    thread without locking. While the profiler is disabled, a block costs one
+    relaxed load and each stage boundary one predictable branch.
+*/
+class LoadProfiler
+{
+public:
+    /** Engine stages, in processing order. New stages go before numStages. */
+    enum Stage
+    {
+        preFilters,
+        oversampling,
+        shaper,
+        postFilters,
+        metering,
+        numStages
+    };
+
+    static const char* getStageName (int stage) noexcept;
+
+    /** Histogram bins are 2.5 % of the deadline wide; the last one collects everything from 125 % up. */
+    static constexpr int numBins = 50;
+    static constexpr double binWidth = 0.025;
+
+    class Histogram
+    {
+    public:
+        void add (double proportionOfDeadline) noexcept
+        {
+            auto bin = juce::jlimit (0, numBins - 1, (int) (proportionOfDeadline / binWidth));
+            bins[(size_t) bin].fetch_add (1, std::memory_order_relaxed);
+        }
+
+        void clear() noexcept
+        {
+            for (auto& bin : bins)
+                bin.store (0, std::memory_order_relaxed);
+        }
+
+        juce::uint32 getCount (int bin) const noexcept  { return bins[(size_t) bin].load (std::memory_order_relaxed); }
+
+    private:
+        std::array<std::atomic<juce::uint32>, numBins> bins {};
+    };
+
+    /** A copy of everything collected so far, safe to keep on the message thread. */
+    struct Report
+    {
+        juce::int64 blocks = 0, overruns = 0, denormalBlocks = 0, allocations = 0;
+        double averageLoad = 0.0, peakProportion = 0.0;
+        double meanStageProportion[numStages] {};
+        juce::uint32 blockHistogram[numBins] {};
+        juce::uint32 stageHistograms[numStages][numBins] {};
+
+        /** Plain text summary with the histograms as columns, for dumping to a file. */
+        juce::String toString() const;
+    };
+
+    //==============================================================================
+    LoadProfiler() = default;
+
+    /** Called from prepareToPlay, while the audio thread is stopped. */
+    void prepare (double sampleRate, int maximumBlockSize);
+
+    void setEnabled (bool shouldBeEnabled) noexcept     { enabled.store (shouldBeEnabled, std::memory_order_relaxed); }
+    bool isEnabled() const noexcept                     { return enabled.load (std::memory_order_relaxed); }
+
+    /** Starts the statistics over; callable from any thread. */
+    void clear() noexcept;
+
+    Report getReport() const;
+    bool writeReport (const juce::File& file) const;
+
+    //==============================================================================
+    /** Wraps one processBlock call. */
+    class ScopedBlock
+    {
+    public:
+        ScopedBlock (LoadProfiler& p, int numSamples) noexcept
+           #if LEMONDRIVE_PROFILING
+            : profiler (p.isEnabled() ? &p : nullptr)
+           #endif
+        {
+           #if LEMONDRIVE_PROFILING
+            if (profiler != nullptr)
+                profiler->beginBlock (numSamples);
+           #else
+            juce::ignoreUnused (p, numSamples);
+           #endif
+        }
+
+        ~ScopedBlock() noexcept
+        {
+           #if LEMONDRIVE_PROFILING
+            if (profiler != nullptr)
+                profiler->endBlock();
+           #endif
+        }
+
+    private:
+       #if LEMONDRIVE_PROFILING
+        LoadProfiler* profiler;
+       #endif
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedBlock)
+    };
+
+    /** Stage timing: take a stamp where the first stage starts, then lap() at the end of each
+        stage, which books the time since the stamp to that stage and returns the next stamp.
+        Both are free outside an enabled block.
+    */
+    juce::uint64 stamp() const noexcept
+    {
+       #if LEMONDRIVE_PROFILING
+        return blockActive ? readCycleCounter() : 0;
+       #else
+        return 0;
+       #endif
+    }
+
+    juce::uint64 lap (Stage stage, juce::uint64 since) noexcept
+    {
+       #if LEMONDRIVE_PROFILING
+        if (blockActive)
+        {
+            auto now = readCycleCounter();
+            stageCycles[stage] += now - since;
+            return now;
+        }
+       #endif
+
+        juce::ignoreUnused (stage, since);
+        return 0;
+    }
+
+    /** Called by the allocation hook; counts only while an enabled block runs on this thread. */
+    static void noteAllocation() noexcept
+    {
+       #if LEMONDRIVE_PROFILING
+        if (auto* profiler = currentBlockProfiler)
+            profiler->allocations.fetch_add (1, std::memory_order_relaxed);
+       #endif
+    }
+
+private:
+    static juce::uint64 readCycleCounter() noexcept
+    {
+       #if JUCE_INTEL
+        return (juce::uint64) __rdtsc();
+       #elif JUCE_ARM && defined (__aarch64__) && (JUCE_GCC || JUCE_CLANG)
+        juce::uint64 value;
+        asm volatile ("mrs %0, cntvct_el0" : "=r" (value));
+        return value;
+       #else
+        return (juce::uint64) juce::Time::getHighResolutionTicks();
+       #endif
+    }
+
+    void beginBlock (int numSamples) noexcept;
+    void endBlock() noexcept;
+
+    static void clearFloatingPointFlags() noexcept;
+    static bool readFloatingPointFlags() noexcept;
+
+    std::atomic<bool> enabled { false };
+    juce::AudioProcessLoadMeasurer loadMeasurer;
+    double sampleRate = 44100.0;
+
+    // audio thread only
+    bool blockActive = false;
+    int blockSamples = 0;
+    juce::int64 blockStartTicks = 0;
+    juce::uint64 blockStartCycles = 0;
+    juce::uint64 stageCycles[numStages] {};
+    double calibrationCycles = 0.0, calibrationSeconds = 0.0;
+
+    static inline thread_local LoadProfiler* currentBlockProfiler = nullptr;
+
+    // written by the audio thread, read and cleared from anywhere
+    std::atomic<juce::int64> blocks { 0 }, denormalBlocks { 0 }, allocations { 0 }, overrunBase { 0 };
+    std::atomic<double> peakProportion { 0.0 };
+    std::atomic<double> stageProportionSums[numStages] {};
+    Histogram blockHistogram;
+    Histogram stageHistograms[numStages];
+
+    JUCE_DECLARE_NON_COPYABLE (LoadProfiler)
+};
@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    MeterFeed.h
+    Created: 18 Oct 2026 3:27:05pm
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*  Audio-to-UI metering.
+
+    processBlock pushes one MeterFrame per block plus a decimated trace of the
+    drive stage into single-producer/single-consumer rings; the editor drains
+    them from its UI timer. Pushing never blocks or allocates: when a ring is
+    full the newest data is dropped. While no editor is attached, isActive()
+    is false and the processor skips all metering work.
+*/
+struct MeterFrame
+{
+    float inputPeak = 0.0f, inputRms = 0.0f;
+    float outputPeak = 0.0f, outputRms = 0.0f;
+    float saturationDb = 0.0f;      // how far the output sits below the small-signal (linear) response
+};
+
+/** One point of the drive stage trace: the signal going into the drive and what came out. */
+struct ScopePoint
+{
+    float input = 0.0f, output = 0.0f;
+};
+
+//==============================================================================
+template <typename ItemType, int capacity>
+class SpscRing
+{
+public:
+    /** Producer side. Returns the number of items actually written. */
+    int push (const ItemType* items, int numItems) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (numItems, start1, size1, start2, size2);
+
+        std::copy (items, items + size1, buffer.begin() + start1);
+        std::copy (items + size1, items + size1 + size2, buffer.begin() + start2);
+
+        fifo.finishedWrite (size1 + size2);
+        return size1 + size2;
+    }
+
+    /** Consumer side. Returns the number of items actually read. */
+    int pop (ItemType* items, int maxItems) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (maxItems, start1, size1, start2, size2);
+
+        std::copy (buffer.begin() + start1, buffer.begin() + start1 + size1, items);
+        std::copy (buffer.begin() + start2, buffer.begin() + start2 + size2, items + size1);
+
+        fifo.finishedRead (size1 + size2);
+        return size1 + size2;
+    }
+
+private:
+    juce::AbstractFifo fifo { capacity };
+    std::array<ItemType, (size_t) capacity> buffer;
+};
+
+//==============================================================================
+class MeterFeed
+{
+public:
+    /** Host-rate samples between two scope points. */
+    static constexpr int scopeDecimation = 16;
+
+    void addConsumer() noexcept         { ++consumers; }
+    void removeConsumer() noexcept      { --consumers; }
+    bool isActive() const noexcept      { return consumers.load (std::memory_order_relaxed) > 0; }
+
+    void pushFrame (const MeterFrame& frame) noexcept                   { frames.push (&frame, 1); }
+    void pushScope (const ScopePoint* points, int numPoints) noexcept   { scope.push (points, numPoints); }
+
+    int popFrames (MeterFrame* dest, int maxFrames) noexcept            { return frames.pop (dest, maxFrames); }
+    int popScope (ScopePoint* dest, int maxPoints) noexcept             { return scope.pop (dest, maxPoints); }
+
+private:
+    std::atomic<int> consumers { 0 };
+    SpscRing<MeterFrame, 256> frames;
+    SpscRing<ScopePoint, 4096> scope;
+};
@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    MeterView.cpp
+    Created: 18 Oct 2026 4:02:51pm
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#include "MeterView.h"
+
+MeterView::MeterView (MeterFeed& f)
+    : feed (f)
+{
+    setInterceptsMouseClicks (false, false);
+    feed.addConsumer();
+}
+
+MeterView::~MeterView()
+{
+    feed.removeConsumer();
+}
+
+void MeterView::update()
+{
+    float inPeak = 0.0f, inRms = 0.0f, outPeak = 0.0f, outRms = 0.0f;
+    bool gotFrames = false;
+
+    for (int num; (num = feed.popFrames (frameScratch.data(), (int) frameScratch.size())) > 0;)
+    {
+        for (int i = 0; i < num; ++i)
+        {
+            auto& frame = frameScratch[(size_t) i];
+            inPeak = juce::jmax (inPeak, frame.inputPeak);
+            outPeak = juce::jmax (outPeak, frame.outputPeak);
+            inRms = frame.inputRms;
+            outRms = frame.outputRms;
+            saturationDb = frame.saturationDb;
+        }
+
+        gotFrames = true;
+    }
+
+    for (int num; (num = feed.popScope (scopeScratch.data(), (int) scopeScratch.size())) > 0;)
+    {
+        for (int i = 0; i < num; ++i)
+        {
+            trace[(size_t) traceWritePosition] = scopeScratch[(size_t) i];
+            traceWritePosition = (traceWritePosition + 1) % traceLength;
+        }
+    }
+
+    input.apply (inPeak, inRms);
+    output.apply (outPeak, outRms);
+
+    if (gotFrames || input.peak > 1.0e-4f || output.peak > 1.0e-4f)
+        repaint();
+}
+
+void MeterView::drawBar (juce::Graphics& g, juce::Rectangle<float> area, const Ballistics& level) const
+{
+    auto toProportion = [] (float gain)
+    {
+        return juce::jlimit (0.0f, 1.0f, juce::jmap (juce::Decibels::gainToDecibels (gain, -60.0f), -60.0f, 0.0f, 0.0f, 1.0f));
+    };
+
+    g.setColour (juce::Colours::black.withAlpha (0.35f));
+    g.fillRect (area);
+
+    g.setColour (juce::Colours::yellow.withAlpha (0.8f));
+    g.fillRect (area.withTop (area.getBottom() - area.getHeight() * toProportion (level.rms)));
+
+    g.setColour (juce::Colours::skyblue);
+    auto peakY = area.getBottom() - area.getHeight() * toProportion (level.peak);
+    g.drawHorizontalLine (juce::roundToInt (peakY), area.getX(), area.getRight());
+}
+
+void MeterView::paint (juce::Graphics& g)
+{
+    auto bounds = getLocalBounds().toFloat();
+
+    drawBar (g, bounds.removeFromLeft (8.0f), input);
+    drawBar (g, bounds.removeFromRight (8.0f), output);
+    bounds.reduce (6.0f, 0.0f);
+
+    g.setColour (juce::Colours::black.withAlpha (0.25f));
+    g.fillRoundedRectangle (bounds, 4.0f);
+
+    // transfer trace: drive input (x) against output (y), both on a +-1 scale
+    auto scopeArea = bounds.reduced (4.0f);
+    auto centre = scopeArea.getCentre();
+    auto halfWidth = scopeArea.getWidth() * 0.5f;
+    auto halfHeight = scopeArea.getHeight() * 0.5f;
+
+    g.setColour (juce::Colours::yellow);
+
+    for (auto& point : trace)
+    {
+        auto x = centre.x + halfWidth * juce::jlimit (-1.0f, 1.0f, point.input);
+        auto y = centre.y - halfHeight * juce::jlimit (-1.0f, 1.0f, point.output);
+        g.fillRect (x - 0.75f, y - 0.75f, 1.5f, 1.5f);
+    }
+
+    g.setColour (juce::Colours::white);
+    g.setFont (11.0f);
+    g.drawText (juce::String (saturationDb, 1) + " dB drive", bounds.reduced (4.0f, 2.0f),
+                juce::Justification::topRight);
+}
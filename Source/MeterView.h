@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    MeterView.h
+    Created: 18 Oct 2026 4:02:51pm
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "MeterFeed.h"
+
+/*  Input/output level bars, saturation readout and a transfer-curve trace,
+    fed from the processor's MeterFeed. Registering with the feed is what turns
+    metering on in the processor, so the audio thread only pays for it while
+    one of these exists.
+*/
+class MeterView : public juce::Component
+{
+public:
+    explicit MeterView (MeterFeed& feed);
+    ~MeterView() override;
+
+    void paint (juce::Graphics&) override;
+
+    /** Drains the feed; called once per display refresh. */
+    void update();
+
+private:
+    struct Ballistics
+    {
+        float peak = 0.0f, rms = 0.0f;
+
+        void apply (float newPeak, float newRms) noexcept
+        {
+            peak = juce::jmax (newPeak, peak * 0.92f);
+            rms = juce::jmax (newRms, rms * 0.85f);
+        }
+    };
+
+    void drawBar (juce::Graphics& g, juce::Rectangle<float> area, const Ballistics& level) const;
+
+    MeterFeed& feed;
+    Ballistics input, output;
+    float saturationDb = 0.0f;
+
+    static constexpr int traceLength = 512;
+    std::array<ScopePoint, traceLength> trace {};
+    int traceWritePosition = 0;
+
+    std::array<MeterFrame, 64> frameScratch;
+    std::array<ScopePoint, 1024> scopeScratch;
+
+   #if JUCE_MAJOR_VERSION >= 7
+    juce::VBlankAttachment vblank { this, [this] { update(); } };
+   #else
+    struct RefreshTimer : public juce::Timer
+    {
+        explicit RefreshTimer (MeterView& v) : view (v) { startTimerHz (60); }
+        void timerCallback() override { view.update(); }
+        MeterView& view;
+    };
+
+    RefreshTimer refreshTimer { *this };
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MeterView)
+};
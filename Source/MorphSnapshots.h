@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    MorphSnapshots.h
+    Created: 23 Oct 2026 3:18:06pm
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*  One complete set of the continuous parameters the engine smooths, as raw values. */
+struct ParameterSnapshot
+{
+    enum Index
+    {
+        drive,      // dB
+        range,
+        volume,     // linear gain
+        lowCut,     // Hz
+        highCut,    // Hz
+        curve,
+        tilt,       // dB
+        numValues
+    };
+
+    float values[numValues] { -20.0f, 1.0f, 1.0f, 50.0f, 18000.0f, 0.5f, 0.0f };
+
+    float operator[] (int index) const noexcept     { return values[index]; }
+    float& operator[] (int index) noexcept          { return values[index]; }
+
+    /** Blends two sets, each value in the domain its ear-relevant steps are even in:
+        dB values and plain factors linearly, gains in dB and frequencies in octaves.
+    */
+    static ParameterSnapshot interpolate (const ParameterSnapshot& a, const ParameterSnapshot& b, float t) noexcept
+    {
+        if (t <= 0.0f)  return a;
+        if (t >= 1.0f)  return b;
+
+        ParameterSnapshot result;
+
+        for (int i = 0; i < numValues; ++i)
+        {
+            switch (i)
+            {
+                case volume:
+                {
+                    auto dbA = juce::Decibels::gainToDecibels (a[i], minimumVolumeDb);
+                    auto dbB = juce::Decibels::gainToDecibels (b[i], minimumVolumeDb);
+                    result[i] = juce::Decibels::decibelsToGain (dbA + t * (dbB - dbA), minimumVolumeDb);
+                    break;
+                }
+
+                case lowCut:
+                case highCut:
+                    result[i] = a[i] * std::pow (b[i] / a[i], t);
+                    break;
+
+                default:
+                    result[i] = a[i] + t * (b[i] - a[i]);
+                    break;
+            }
+        }
+
+        return result;
+    }
+
+    static constexpr float minimumVolumeDb = -100.0f;
+};
+
+/*  Everything about the A/B slots the audio thread needs, published as one piece. */
+struct MorphState
+{
+    ParameterSnapshot a, b;
+    bool hasA = false, hasB = false;
+
+    /** While the message thread writes a whole set into the parameters one at a time,
+        the engine keeps using heldSet instead of the half-updated live values.
+    */
+    bool holdSet = false;
+    ParameterSnapshot heldSet;
+
+    bool isMorphing() const noexcept    { return hasA && hasB; }
+};
+
+//==============================================================================
+/*  Single-writer, single-reader triple buffer. The writer always has a slot of its
+    own to fill, so publishing never waits for the reader, and the reader only ever
+    sees complete values. Lock- and allocation-free on both sides.
+*/
+template <typename Type>
+class TripleBuffer
+{
+public:
+    /** Writer side; callers must make sure only one thread writes at a time. */
+    void write (const Type& value) noexcept
+    {
+        slots[backIndex] = value;
+        backIndex = middle.exchange (backIndex | dirtyBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    /** Reader side: the newest value written so far. */
+    const Type& read() noexcept
+    {
+        if ((middle.load (std::memory_order_relaxed) & dirtyBit) != 0)
+            frontIndex = middle.exchange (frontIndex, std::memory_order_acq_rel) & indexMask;
+
+        return slots[frontIndex];
+    }
+
+private:
+    static constexpr int indexMask = 3, dirtyBit = 4;
+
+    Type slots[3] {};
+    std::atomic<int> middle { 1 };
+    int backIndex = 2, frontIndex = 0;
+};
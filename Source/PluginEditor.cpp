@@ -12,8 +12,9 @@
 #include "TSlider.h"
 //==============================================================================
 LemonDriveAudioProcessorEditor::LemonDriveAudioProcessorEditor (LemonDriveAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), meterView (p.getMeterFeed()), profilerView (p.getLoadProfiler()), audioProcessor (p)
 {
+    addAndMakeVisible (meterView);
 
     //drive
 
@@ -66,6 +67,19 @@ LemonDriveAudioProcessorEditor::LemonDriveAudioProcessorEditor (LemonDriveAudioP
     cutOffLabel.attachToComponent (&cutOffSlider, false);
     
     cutOffSliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, "LOWCUT", cutOffSlider);
+
+     //===============================================================================================================
+    //High Cut
+
+    highCutSlider.setLookAndFeel(&knobDesign);
+
+    addAndMakeVisible(highCutSlider);
+
+    addAndMakeVisible (highCutLabel);
+    highCutLabel.setText ("High Cut", juce::dontSendNotification);
+    highCutLabel.attachToComponent (&highCutSlider, false);
+
+    highCutSliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, "HIGHCUT", highCutSlider);
 // ================================
     curveSlider.setLookAndFeel(&knobDesign);
     addAndMakeVisible(curveSlider);
@@ -74,6 +88,36 @@ LemonDriveAudioProcessorEditor::LemonDriveAudioProcessorEditor (LemonDriveAudioP
     curveLabel.attachToComponent (&curveSlider, false);
     
     curveSliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, "CURVE", curveSlider);
+
+     //===============================================================================================================
+    //A/B snapshots and morph
+
+    morphSlider.setLookAndFeel(&knobDesign);
+    addAndMakeVisible(morphSlider);
+    addAndMakeVisible (morphLabel);
+    morphLabel.setText ("Morph", juce::dontSendNotification);
+    morphLabel.attachToComponent (&morphSlider, false);
+
+    morphSliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, "MORPH", morphSlider);
+
+    // A and B store the current knobs; once both are stored, Morph blends between them
+    snapshotAButton.onClick = [this] { audioProcessor.storeSnapshot (LemonDriveAudioProcessor::SnapshotSlot::a); updateSnapshotButtons(); };
+    snapshotBButton.onClick = [this] { audioProcessor.storeSnapshot (LemonDriveAudioProcessor::SnapshotSlot::b); updateSnapshotButtons(); };
+    clearSnapshotsButton.onClick = [this] { audioProcessor.clearSnapshots(); updateSnapshotButtons(); };
+
+    for (auto* button : { &snapshotAButton, &snapshotBButton, &clearSnapshotsButton })
+        addAndMakeVisible (button);
+
+    updateSnapshotButtons();
+
+    // Load shows the profiler over the knobs; profiling keeps running with the editor closed
+    // until it is switched off here again
+    profilerButton.setClickingTogglesState (true);
+    profilerButton.onClick = [this] { showProfiler (profilerButton.getToggleState()); };
+    addAndMakeVisible (profilerButton);
+    addChildComponent (profilerView);
+    showProfiler (audioProcessor.getLoadProfiler().isEnabled());
+
 //    setResizable(true, true);
 //
 //    setResizeLimits(400, 400, 800, 1000);
@@ -82,23 +126,66 @@ LemonDriveAudioProcessorEditor::LemonDriveAudioProcessorEditor (LemonDriveAudioP
 
 LemonDriveAudioProcessorEditor::~LemonDriveAudioProcessorEditor()
 {
+    DBG ("LemonDrive editor paint times: " << frameTimes.getDescription());
 }
 
 //==============================================================================
 void LemonDriveAudioProcessorEditor::paint (juce::Graphics& g)
 {
-    
-    pluginBG = juce::ImageCache::getFromMemory(BinaryData::bg_png,BinaryData::bg_pngSize);
-    g.drawImageWithin(pluginBG, 0, 0, AudioProcessorEditor::getWidth(), AudioProcessorEditor::getHeight(), juce::RectanglePlacement::stretchToFit);
+    frameTimes.frameStarted();
+
+    // decoded once per process, then only rescaled when the editor size or display scale changes
+    if (pluginBG.isNull())
+        pluginBG = resources->getImage(BinaryData::bg_png,BinaryData::bg_pngSize);
+
+    background.draw (g, getLocalBounds(), pluginBG);
 //    g.fillAll (juce::Colours::tomato);
 
     g.setColour (juce::Colours::white);
 }
 
+void LemonDriveAudioProcessorEditor::paintOverChildren (juce::Graphics& g)
+{
+    frameTimes.frameFinished();
+
+   #if LEMONDRIVE_SHOW_FRAME_TIMES
+    g.setColour (juce::Colours::white);
+    g.setFont (11.0f);
+    g.drawText (frameTimes.getDescription(), getLocalBounds().removeFromBottom (14).reduced (4, 0),
+                juce::Justification::centredLeft);
+   #else
+    juce::ignoreUnused (g);
+   #endif
+}
+
+void LemonDriveAudioProcessorEditor::updateSnapshotButtons()
+{
+    snapshotAButton.setToggleState (audioProcessor.hasSnapshot (LemonDriveAudioProcessor::SnapshotSlot::a), juce::dontSendNotification);
+    snapshotBButton.setToggleState (audioProcessor.hasSnapshot (LemonDriveAudioProcessor::SnapshotSlot::b), juce::dontSendNotification);
+    morphSlider.setEnabled (snapshotAButton.getToggleState() && snapshotBButton.getToggleState());
+}
+
+void LemonDriveAudioProcessorEditor::showProfiler (bool shouldShow)
+{
+    audioProcessor.getLoadProfiler().setEnabled (shouldShow);
+    profilerButton.setToggleState (shouldShow, juce::dontSendNotification);
+    profilerView.setVisible (shouldShow);
+}
+
 void LemonDriveAudioProcessorEditor::resized()
 {
+    meterView.setBounds (getLocalBounds().removeFromTop (175).removeFromBottom (70).reduced (20, 4));
+
     juce::Rectangle<int> bounds = getLocalBounds().removeFromBottom(325);
+    auto snapshotRow = bounds.removeFromBottom(25).reduced(20, 2);
     bounds = bounds.removeFromTop(300);
+
+    auto buttonWidth = snapshotRow.getWidth() / 4;
+    snapshotAButton.setBounds (snapshotRow.removeFromLeft (buttonWidth).reduced (2, 0));
+    snapshotBButton.setBounds (snapshotRow.removeFromLeft (buttonWidth).reduced (2, 0));
+    profilerButton.setBounds (snapshotRow.removeFromRight (buttonWidth).reduced (2, 0));
+    clearSnapshotsButton.setBounds (snapshotRow.removeFromRight (buttonWidth).reduced (2, 0));
+    profilerView.setBounds (bounds.reduced (10, 0));
     int knobHeight = 80;
     int knobWidth = 80;
     
@@ -116,7 +203,8 @@ void LemonDriveAudioProcessorEditor::resized()
     flexbox.items.add(juce::FlexItem(knobHeight, knobWidth, volumeSlider));
     flexbox.items.add(juce::FlexItem(knobHeight, knobWidth, cutOffSlider));
     flexbox.items.add(juce::FlexItem(knobHeight, knobWidth, curveSlider));
-//    flexbox.items.add(juce::FlexItem(knobHeight, knobWidth, highCutSlider));
+    flexbox.items.add(juce::FlexItem(knobHeight, knobWidth, highCutSlider));
+    flexbox.items.add(juce::FlexItem(knobHeight, knobWidth, morphSlider));
 
     flexbox.performLayout(bounds);
 
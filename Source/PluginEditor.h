@@ -13,6 +13,10 @@
 #include "KnobDesign.h"
 #include "TSlider.h"
 #include "TLabel.h"
+#include "RenderCache.h"
+#include "SharedResources.h"
+#include "MeterView.h"
+#include "ProfilerView.h"
 
 //==============================================================================
 /**
@@ -25,16 +29,29 @@ public:
 
     //==============================================================================
     void paint (juce::Graphics&) override;
+    void paintOverChildren (juce::Graphics&) override;
     void resized() override;
 
+    const FrameTimeCounter& getFrameTimes() const noexcept { return frameTimes; }
+
 private:
+    void updateSnapshotButtons();
+    void showProfiler (bool shouldShow);
+
+    SharedResources::Pointer resources;
     KnobDesign knobDesign;
 
     juce::Image pluginBG;
-    TSlider driveSlider, rangeSlider, volumeSlider, cutOffSlider, highCutSlider, curveSlider;
-    TLabel driveLabel, rangeLabel, volumeLabel, cutOffLabel, highCutLabel, curveLabel;
-
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> driveSliderAttachment,rangeSliderAttachment,blendSliderAttachment,volumeSliderAttachment,cutOffSliderAttachment,highCutSliderAttachment, curveSliderAttachment;
+    ScaledBackground background;
+    FrameTimeCounter frameTimes;
+    MeterView meterView;
+    TSlider driveSlider, rangeSlider, volumeSlider, cutOffSlider, highCutSlider, curveSlider, morphSlider;
+    TLabel driveLabel, rangeLabel, volumeLabel, cutOffLabel, highCutLabel, curveLabel, morphLabel;
+    juce::TextButton snapshotAButton { "A" }, snapshotBButton { "B" }, clearSnapshotsButton { "A/B Off" };
+    juce::TextButton profilerButton { "Load" };
+    ProfilerView profilerView;
+
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> driveSliderAttachment,rangeSliderAttachment,blendSliderAttachment,volumeSliderAttachment,cutOffSliderAttachment,highCutSliderAttachment, curveSliderAttachment, morphSliderAttachment;
     LemonDriveAudioProcessor& audioProcessor;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LemonDriveAudioProcessorEditor)
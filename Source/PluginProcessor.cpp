@@ -1,225 +1,599 @@
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin processor.
-
-  ==============================================================================
-*/
-
-#include "PluginProcessor.h"
-#include "PluginEditor.h"
-
-//==============================================================================
-LemonDriveAudioProcessor::LemonDriveAudioProcessor()
-#ifndef JucePlugin_PreferredChannelConfigurations
-     : AudioProcessor (BusesProperties()
-                     #if ! JucePlugin_IsMidiEffect
-                      #if ! JucePlugin_IsSynth
-                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
-                      #endif
-                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
-                     #endif
-                       )
-#endif
-{
-}
-
-LemonDriveAudioProcessor::~LemonDriveAudioProcessor()
-{
-}
-
-//==============================================================================
-const juce::String LemonDriveAudioProcessor::getName() const
-{
-    return JucePlugin_Name;
-}
-
-bool LemonDriveAudioProcessor::acceptsMidi() const
-{
-   #if JucePlugin_WantsMidiInput
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-bool LemonDriveAudioProcessor::producesMidi() const
-{
-   #if JucePlugin_ProducesMidiOutput
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-bool LemonDriveAudioProcessor::isMidiEffect() const
-{
-   #if JucePlugin_IsMidiEffect
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-double LemonDriveAudioProcessor::getTailLengthSeconds() const
-{
-    return 0.0;
-}
-
-int LemonDriveAudioProcessor::getNumPrograms()
-{
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
-}
-
-int LemonDriveAudioProcessor::getCurrentProgram()
-{
-    return 0;
-}
-
-void LemonDriveAudioProcessor::setCurrentProgram (int index)
-{
-}
-
-const juce::String LemonDriveAudioProcessor::getProgramName (int index)
-{
-    return {};
-}
-
-void LemonDriveAudioProcessor::changeProgramName (int index, const juce::String& newName)
-{
-}
-
-//==============================================================================
-void LemonDriveAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
-{
-    filter.setType(juce::dsp::LinkwitzRileyFilterType::highpass);
-
-    dsp::ProcessSpec spec;
-    spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = getTotalNumInputChannels();
-    
-    filter.prepare(spec);
-    reset();
-}
-
-void LemonDriveAudioProcessor::releaseResources()
-{
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
-}
-
-#ifndef JucePlugin_PreferredChannelConfigurations
-bool LemonDriveAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
-{
-  #if JucePlugin_IsMidiEffect
-    juce::ignoreUnused (layouts);
-    return true;
-  #else
-
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
-
-    // This checks if the input layout matches the output layout
-   #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-        return false;
-   #endif
-
-    return true;
-  #endif
-}
-#endif
-
-
-void LemonDriveAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
-{
-    juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
-    filter.setCutoffFrequency(apvts.getRawParameterValue ("LOWCUT")->load());
-    float drive = apvts.getRawParameterValue("DRIVE")->load();
-    float range = apvts.getRawParameterValue("RANGE")->load();
-    float volume = apvts.getRawParameterValue("VOLUME")->load();
-    float curve = apvts.getRawParameterValue("CURVE")->load();
-  
-
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-    buffer.clear (i, 0, buffer.getNumSamples());
-
-    auto audioBlock = juce::dsp::AudioBlock<float> (buffer);
-    auto context = juce::dsp::ProcessContextReplacing<float> (audioBlock);
-    filter.process (context);
-    
-    
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
-    {
-        auto* channelData = buffer.getWritePointer (channel);
-
-        for(int sample = 0; sample < buffer.getNumSamples(); sample ++)
-        {
-
-            channelData[sample] *= (Decibels::decibelsToGain(drive) * range);
-
-            auto drivenSignal = 2.0f / _pi * atan(_pi/(1-curve) * channelData[sample]);
-            channelData[sample] = drivenSignal * volume;
-
-        }
-        
-   }
-
-}
-
-//==============================================================================
-bool LemonDriveAudioProcessor::hasEditor() const
-{
-    return true; // (change this to false if you choose to not supply an editor)
-}
-
-juce::AudioProcessorEditor* LemonDriveAudioProcessor::createEditor()
-{
-    return new LemonDriveAudioProcessorEditor (*this);
-}
-
-//==============================================================================
-void LemonDriveAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
-{
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml (state.createXml());
-    copyXmlToBinary (*xml, destData);
-}
-
-void LemonDriveAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
-{
-    std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
-
-    if (xmlState.get() != nullptr)
-        if (xmlState->hasTagName (apvts.state.getType()))
-        apvts.replaceState (juce::ValueTree::fromXml (*xmlState));
-}
-void LemonDriveAudioProcessor::reset()
-{
-    filter.reset();
-
-}
-
-juce::AudioProcessorValueTreeState::ParameterLayout LemonDriveAudioProcessor:: createParameters()
-{
-    std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
-    
-    params.push_back(std::make_unique<juce::AudioParameterFloat>("DRIVE", "Drive", -50.f, 0.f, -20.f));
-    params.push_back(std::make_unique<juce::AudioParameterFloat>("RANGE", "Range", 1.f, 4.f, 1.f));
-    params.push_back(std::make_unique<juce::AudioParameterFloat>("VOLUME", "Volume", 0.f, 1.f, 0.999f));
-    params.push_back(std::make_unique<juce::AudioParameterFloat>("LOWCUT", "LowCut", 20.f, 300.f, 50.f));
-    params.push_back(std::make_unique<juce::AudioParameterFloat>("HIGHCUT", "HighCut", 2000.f, 20000.f, 18000.f));
-    params.push_back(std::make_unique<juce::AudioParameterFloat>("CURVE", "Curve", 0.f, 0.9f, 0.5f));
-    return {params.begin(), params.end()};
-}
-//==============================================================================
-// This creates new instances of the plugin..
-juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
-{
-    return new LemonDriveAudioProcessor();
-}
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin processor.
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+
+//==============================================================================
+LemonDriveAudioProcessor::LemonDriveAudioProcessor()
+#ifndef JucePlugin_PreferredChannelConfigurations
+     : AudioProcessor (BusesProperties()
+                     #if ! JucePlugin_IsMidiEffect
+                      #if ! JucePlugin_IsSynth
+                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
+                      #endif
+                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                     #endif
+                       )
+#endif
+{
+    parameters.drive = apvts.getRawParameterValue ("DRIVE");
+    parameters.range = apvts.getRawParameterValue ("RANGE");
+    parameters.volume = apvts.getRawParameterValue ("VOLUME");
+    parameters.lowCut = apvts.getRawParameterValue ("LOWCUT");
+    parameters.highCut = apvts.getRawParameterValue ("HIGHCUT");
+    parameters.curve = apvts.getRawParameterValue ("CURVE");
+    parameters.shaper = apvts.getRawParameterValue ("SHAPER");
+    parameters.adaa = apvts.getRawParameterValue ("ADAA");
+    parameters.oversampling = apvts.getRawParameterValue ("OVERSAMPLING");
+    parameters.osFilter = apvts.getRawParameterValue ("OSFILTER");
+    parameters.osOffline = apvts.getRawParameterValue ("OSOFFLINE");
+    parameters.smoothing = apvts.getRawParameterValue ("SMOOTHING");
+    parameters.link = apvts.getRawParameterValue ("LINK");
+    parameters.tilt = apvts.getRawParameterValue ("TILT");
+    parameters.morph = apvts.getRawParameterValue ("MORPH");
+    parameters.bands = apvts.getRawParameterValue ("BANDS");
+    parameters.cutMode = apvts.getRawParameterValue ("CUTMODE");
+    parameters.dynSource = apvts.getRawParameterValue ("DYNSOURCE");
+    parameters.dynAttack = apvts.getRawParameterValue ("DYNATTACK");
+    parameters.dynRelease = apvts.getRawParameterValue ("DYNRELEASE");
+    parameters.dynDrive = apvts.getRawParameterValue ("DYNDRIVE");
+    parameters.dynCut = apvts.getRawParameterValue ("DYNCUT");
+
+    for (int i = 0; i < MultibandSettings::maxBands - 1; ++i)
+        parameters.crossovers[i] = apvts.getRawParameterValue ("XOVER" + juce::String (i + 1));
+
+    for (int band = 0; band < MultibandSettings::maxBands; ++band)
+    {
+        parameters.bandDrive[band] = apvts.getRawParameterValue ("DRIVE" + juce::String (band + 1));
+        parameters.bandCurve[band] = apvts.getRawParameterValue ("CURVE" + juce::String (band + 1));
+        parameters.bandVolume[band] = apvts.getRawParameterValue ("VOLUME" + juce::String (band + 1));
+    }
+
+    parameters.snapshots = &snapshotExchange;
+
+    // one mapped bank for every instance in the process
+    presetBank = sharedResources->getPresetBank (*this);
+
+    updateTailLength();
+    startTimerHz (20);
+}
+
+LemonDriveAudioProcessor::~LemonDriveAudioProcessor()
+{
+    stopTimer();
+}
+
+//==============================================================================
+const juce::String LemonDriveAudioProcessor::getName() const
+{
+    return JucePlugin_Name;
+}
+
+bool LemonDriveAudioProcessor::acceptsMidi() const
+{
+   #if JucePlugin_WantsMidiInput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool LemonDriveAudioProcessor::producesMidi() const
+{
+   #if JucePlugin_ProducesMidiOutput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool LemonDriveAudioProcessor::isMidiEffect() const
+{
+   #if JucePlugin_IsMidiEffect
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+double LemonDriveAudioProcessor::getTailLengthSeconds() const
+{
+    // the filters' ring-out plus whatever the oversampler still holds
+    auto sampleRate = getSampleRate();
+    auto latencySeconds = sampleRate > 0.0 ? (double) getLatencySamples() / sampleRate : 0.0;
+
+    return filterTailSeconds.load() + latencySeconds;
+}
+
+void LemonDriveAudioProcessor::updateTailLength()
+{
+    auto multiband = parameters.getMultibandSettings();
+
+    auto getTail = [&multiband] (const ParameterSnapshot& snapshot)
+    {
+        auto settings = getChainSettings (snapshot);
+        settings.multiband = multiband;
+        return DriveEngine<float>::getTailLengthSeconds (settings);
+    };
+
+    auto tail = getTail (parameters.getLiveSnapshot());
+
+    {
+        // while morphing, the filters follow the slots rather than the knobs
+        const juce::ScopedLock sl (snapshotLock);
+
+        if (morphState.isMorphing())
+            for (auto* snapshot : { &morphState.a, &morphState.b })
+                tail = juce::jmax (tail, getTail (*snapshot));
+    }
+
+    filterTailSeconds = tail;
+}
+
+int LemonDriveAudioProcessor::getNumPrograms()
+{
+    // NB: some hosts don't cope very well if you tell them there are 0 programs,
+    // so this should be at least 1, even if the bank couldn't be read.
+    return juce::jmax (1, presetBank->getNumPresets());
+}
+
+int LemonDriveAudioProcessor::getCurrentProgram()
+{
+    return currentProgram;
+}
+
+void LemonDriveAudioProcessor::setCurrentProgram (int index)
+{
+    // reads the values straight out of the mapped bank: no allocation, no parsing
+    if (juce::isPositiveAndBelow (index, presetBank->getNumPresets()))
+    {
+        currentProgram = index;
+
+        holdParameters (true);
+        presetBank->apply (*this, index);
+        holdParameters (false);
+    }
+}
+
+const juce::String LemonDriveAudioProcessor::getProgramName (int index)
+{
+    return presetBank->getName (index);
+}
+
+void LemonDriveAudioProcessor::changeProgramName (int index, const juce::String& newName)
+{
+    // the bank is shared and read-only
+    juce::ignoreUnused (index, newName);
+}
+
+//==============================================================================
+void LemonDriveAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+{
+    // the host picks the precision before preparing, so only that engine needs its buffers
+    auto numChannels = getMainBusNumInputChannels();
+    auto numSidechainChannels = getBusCount (true) > 1 ? getChannelCountOfBus (true, 1) : 0;
+    loadProfiler.prepare (sampleRate, samplesPerBlock);
+
+    // built here rather than on the worker thread, so a linear-phase session reports its
+    // full latency from the start. Otherwise nothing is designed until CUTMODE is switched,
+    // and kernels left over from another rate are dropped.
+    if (isLinearPhase())
+    {
+        auto cutoffs = getFilterTargets();
+        cutKernelDesigner.prepare (cutoffs[ParameterSnapshot::lowCut], cutoffs[ParameterSnapshot::highCut], sampleRate, cutKernelState);
+    }
+    else
+    {
+        cutKernelDesigner.release (cutKernelState);
+    }
+
+    diodeTables.prepare (*sharedResources, sampleRate);
+
+    if (isUsingDoublePrecision())
+    {
+        floatEngine.release();
+        doubleEngine.prepare (sampleRate, samplesPerBlock, numChannels, numSidechainChannels, isNonRealtime(), cutKernelState, diodeTables);
+        engineLatency = doubleEngine.getLatencySamples();
+    }
+    else
+    {
+        doubleEngine.release();
+        floatEngine.prepare (sampleRate, samplesPerBlock, numChannels, numSidechainChannels, isNonRealtime(), cutKernelState, diodeTables);
+        engineLatency = floatEngine.getLatencySamples();
+    }
+
+    setLatencySamples (engineLatency.load());
+
+    // make sure the table shaper has something to read from the very first block
+    if (isTableShaper())
+        publishShaperTable (parameters.curve->load());
+}
+
+void LemonDriveAudioProcessor::releaseResources()
+{
+    // When playback stops, you can use this as an opportunity to free up any
+    // spare memory, etc.
+    floatEngine.release();
+    doubleEngine.release();
+}
+
+void LemonDriveAudioProcessor::timerCallback()
+{
+    // latency changes from the audio thread, told to the host here rather than from processBlock
+    auto latency = engineLatency.load();
+
+    if (latency != getLatencySamples())
+        setLatencySamples (latency);
+
+    // picks up knob moves and automation; slot edits update it straight away
+    updateTailLength();
+
+    // tables only while they are in use; switching to Table builds one for the current CURVE,
+    // and publishing skips a CURVE it already has
+    if (isTableShaper())
+        publishShaperTable (parameters.curve->load());
+
+    // new kernels only while they are in use; the designer skips cutoffs it already has
+    if (isLinearPhase() && getSampleRate() > 0.0)
+    {
+        // switching to linear phase sizes the convolvers here; only the prepared engine does anything
+        floatEngine.prepareLinearPhase();
+        doubleEngine.prepareLinearPhase();
+
+        auto cutoffs = getFilterTargets();
+        cutKernelDesigner.request (cutoffs[ParameterSnapshot::lowCut], cutoffs[ParameterSnapshot::highCut], getSampleRate());
+    }
+}
+
+bool LemonDriveAudioProcessor::isTableShaper() const noexcept
+{
+    return (DriveParameters::ShaperMode) (int) parameters.shaper->load() == DriveParameters::ShaperMode::table;
+}
+
+bool LemonDriveAudioProcessor::isLinearPhase() const noexcept
+{
+    return (DriveParameters::CutMode) (int) parameters.cutMode->load() == DriveParameters::CutMode::linearPhase;
+}
+
+ParameterSnapshot LemonDriveAudioProcessor::getFilterTargets() const
+{
+    // the same values the engine heads for: the A/B blend, the held set, or the knobs
+    const juce::ScopedLock sl (snapshotLock);
+
+    if (morphState.isMorphing())
+        return ParameterSnapshot::interpolate (morphState.a, morphState.b, parameters.morph->load());
+
+    if (morphState.holdSet)
+        return morphState.heldSet;
+
+    return parameters.getLiveSnapshot();
+}
+
+void LemonDriveAudioProcessor::publishShaperTable (float curve)
+{
+    const juce::ScopedLock sl (tableLock);
+
+    auto* pending = pendingTable.load();
+
+    if (pending == nullptr || pending->getCurve() != curve)
+    {
+        auto table = sharedResources->getShaperTable (curve);
+        retainedTables.addIfNotAlreadyThere (table.get());
+        pendingTable = table.get();
+    }
+
+    // drop whatever the audio thread can no longer reach
+    for (int i = retainedTables.size(); --i >= 0;)
+    {
+        auto* t = retainedTables.getObjectPointerUnchecked (i);
+
+        if (t != pendingTable.load() && t != activeTableInUse.load() && t != fadingTableInUse.load())
+            retainedTables.remove (i);
+    }
+}
+
+void LemonDriveAudioProcessor::storeSnapshot (SnapshotSlot slot)
+{
+    const juce::ScopedLock sl (snapshotLock);
+
+    if (slot == SnapshotSlot::a)
+    {
+        morphState.a = parameters.getLiveSnapshot();
+        morphState.hasA = true;
+    }
+    else
+    {
+        morphState.b = parameters.getLiveSnapshot();
+        morphState.hasB = true;
+    }
+
+    snapshotExchange.write (morphState);
+    updateTailLength();
+}
+
+void LemonDriveAudioProcessor::clearSnapshots()
+{
+    const juce::ScopedLock sl (snapshotLock);
+    morphState.hasA = morphState.hasB = false;
+    snapshotExchange.write (morphState);
+    updateTailLength();
+}
+
+bool LemonDriveAudioProcessor::hasSnapshot (SnapshotSlot slot) const
+{
+    const juce::ScopedLock sl (snapshotLock);
+    return slot == SnapshotSlot::a ? morphState.hasA : morphState.hasB;
+}
+
+void LemonDriveAudioProcessor::holdParameters (bool shouldHold)
+{
+    // the audio thread keeps the complete set from before the change until the new one is complete too
+    const juce::ScopedLock sl (snapshotLock);
+    morphState.holdSet = shouldHold;
+
+    if (shouldHold)
+        morphState.heldSet = parameters.getLiveSnapshot();
+
+    snapshotExchange.write (morphState);
+}
+
+void LemonDriveAudioProcessor::updateShaperTable()
+{
+    if (tableState.fading != nullptr)
+    {
+        if (tableState.fadePosition < ShaperTableState::fadeLength)
+            return;
+
+        tableState.fading = nullptr;
+        fadingTableInUse = nullptr;
+    }
+
+    auto* latest = pendingTable.load();
+
+    if (latest == tableState.active)
+        return;
+
+    // advertise both tables before touching them, then check the new one wasn't replaced meanwhile
+    fadingTableInUse = tableState.active;
+    activeTableInUse = latest;
+
+    if (pendingTable.load() != latest)
+    {
+        activeTableInUse = tableState.active;
+        return;
+    }
+
+    tableState.fading = tableState.active;
+    tableState.active = latest;
+    tableState.fadePosition = 0;
+}
+
+#ifndef JucePlugin_PreferredChannelConfigurations
+bool LemonDriveAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+  #if JucePlugin_IsMidiEffect
+    juce::ignoreUnused (layouts);
+    return true;
+  #else
+
+    // any discrete or surround layout the core has state for: channels are processed in
+    // SIMD-width groups, and wider layouts would leave the extra channels dry but delayed
+    auto mainChannels = layouts.getMainOutputChannelSet().size();
+
+    if (mainChannels == 0 || mainChannels > lemondrive::maxChannels)
+        return false;
+
+    // This checks if the input layout matches the output layout
+   #if ! JucePlugin_IsSynth
+    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+        return false;
+
+    // the sidechain can be off or any width; its channels are spread over the main ones
+    if (layouts.inputBuses.size() > 1 && layouts.inputBuses[1].size() > lemondrive::maxChannels)
+        return false;
+   #endif
+
+    return true;
+  #endif
+}
+#endif
+
+
+void LemonDriveAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processWithEngine (buffer, floatEngine);
+}
+
+void LemonDriveAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processWithEngine (buffer, doubleEngine);
+}
+
+template <typename SampleType>
+void LemonDriveAudioProcessor::processWithEngine (juce::AudioBuffer<SampleType>& buffer, DriveEngine<SampleType>& engine)
+{
+    juce::ScopedNoDenormals noDenormals;
+    LoadProfiler::ScopedBlock profiledBlock (loadProfiler, buffer.getNumSamples());
+    auto totalNumInputChannels  = getMainBusNumInputChannels();
+    auto totalNumOutputChannels = getMainBusNumOutputChannels();
+
+    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+    buffer.clear (i, 0, buffer.getNumSamples());
+
+    // the sidechain's channels come after the main input's; a disabled bus has none
+    auto sidechain = getBusCount (true) > 1 ? getBusBuffer (buffer, true, 1) : juce::AudioBuffer<SampleType>();
+
+    if (isTableShaper())
+        updateShaperTable();
+
+    if (isLinearPhase())
+        cutKernelDesigner.update (cutKernelState);
+
+    engine.process (buffer, totalNumInputChannels, sidechain, isNonRealtime(), tableState, cutKernelState);
+
+    engineLatency = engine.getLatencySamples();
+}
+
+//==============================================================================
+bool LemonDriveAudioProcessor::hasEditor() const
+{
+    return true; // (change this to false if you choose to not supply an editor)
+}
+
+juce::AudioProcessorEditor* LemonDriveAudioProcessor::createEditor()
+{
+    return new LemonDriveAudioProcessorEditor (*this);
+}
+
+//==============================================================================
+void LemonDriveAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
+{
+    MorphState slots;
+
+    {
+        const juce::ScopedLock sl (snapshotLock);
+        slots = morphState;
+    }
+
+    StateFormat::write (*this, currentProgram, slots, destData);
+}
+
+void LemonDriveAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
+{
+    int program = currentProgram;
+    MorphState slots;
+
+    holdParameters (true);
+
+    if (StateFormat::read (*this, data, sizeInBytes, program, slots))
+    {
+        currentProgram = juce::jlimit (0, getNumPrograms() - 1, program);
+
+        const juce::ScopedLock sl (snapshotLock);
+        morphState.a = slots.a;
+        morphState.b = slots.b;
+        morphState.hasA = slots.hasA;
+        morphState.hasB = slots.hasB;
+    }
+    else
+    {
+        // sessions saved before the binary format hold the parameter tree as XML
+        std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
+
+        if (xmlState.get() != nullptr && xmlState->hasTagName (apvts.state.getType()))
+        {
+            // replaceState() keeps the current value of anything the tree lacks, so parameters
+            // added since the session was saved go back to their defaults first
+            StateFormat::applyValues (*this, nullptr, 0);
+            apvts.replaceState (juce::ValueTree::fromXml (*xmlState));
+
+            // it had no A/B slots either, and stored ones would keep morphing over what was loaded
+            const juce::ScopedLock sl (snapshotLock);
+            morphState.hasA = morphState.hasB = false;
+        }
+    }
+
+    holdParameters (false);
+    updateTailLength();
+}
+void LemonDriveAudioProcessor::reset()
+{
+    floatEngine.reset();
+    doubleEngine.reset();
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout LemonDriveAudioProcessor:: createParameters()
+{
+    std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
+    
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("DRIVE", "Drive", -50.f, 0.f, -20.f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("RANGE", "Range", 1.f, 4.f, 1.f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("VOLUME", "Volume", 0.f, 1.f, 0.999f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("LOWCUT", "LowCut", 20.f, 300.f, 50.f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("HIGHCUT", "HighCut", 2000.f, 20000.f, 18000.f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("CURVE", "Curve", 0.f, 0.9f, 0.5f));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("SHAPER", "Shaper", juce::StringArray { "Fast", "Reference", "Table", "Diode", "Diode Table" }, 0));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("ADAA", "Anti-Aliasing", juce::StringArray { "Off", "1st Order", "2nd Order" }, 0));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("OVERSAMPLING", "Oversampling", juce::StringArray { "Off", "2x", "4x", "8x" }, 0));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("OSFILTER", "Oversampling Filter", juce::StringArray { "Polyphase IIR", "Linear Phase FIR" }, 0));
+    params.push_back(std::make_unique<juce::AudioParameterBool>("OSOFFLINE", "Offline Max Quality", true));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("SMOOTHING", "Smoothing", juce::StringArray { "Per Block", "Sample Accurate" }, 0));
+    params.push_back(std::make_unique<juce::AudioParameterBool>("LINK", "Link Channels", false));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("TILT", "Tilt", -12.f, 12.f, 0.f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("MORPH", "Morph", 0.f, 1.f, 0.f));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("BANDS", "Bands", juce::StringArray { "Off", "2", "3", "4" }, 0));
+
+    const float defaultCrossovers[] { 150.f, 1000.f, 5000.f };
+
+    for (int i = 0; i < MultibandSettings::maxBands - 1; ++i)
+    {
+        juce::NormalisableRange<float> crossoverRange (40.f, 16000.f);
+        crossoverRange.setSkewForCentre (1000.f);
+
+        auto number = juce::String (i + 1);
+        params.push_back(std::make_unique<juce::AudioParameterFloat>("XOVER" + number, "Crossover " + number, crossoverRange, defaultCrossovers[i]));
+    }
+
+    for (int band = 0; band < MultibandSettings::maxBands; ++band)
+    {
+        auto number = juce::String (band + 1);
+        params.push_back(std::make_unique<juce::AudioParameterFloat>("DRIVE" + number, "Band " + number + " Drive", -50.f, 0.f, -20.f));
+        params.push_back(std::make_unique<juce::AudioParameterFloat>("CURVE" + number, "Band " + number + " Curve", 0.f, 0.9f, 0.5f));
+        params.push_back(std::make_unique<juce::AudioParameterFloat>("VOLUME" + number, "Band " + number + " Volume", 0.f, 1.f, 1.f));
+    }
+
+    // last, so states saved before it still line up
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("CUTMODE", "Cut Filters", juce::StringArray { "Minimum Phase", "Linear Phase" }, 0));
+
+    juce::NormalisableRange<float> attackRange (0.1f, 100.f);
+    attackRange.setSkewForCentre (5.f);
+    juce::NormalisableRange<float> releaseRange (5.f, 2000.f);
+    releaseRange.setSkewForCentre (150.f);
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("DYNSOURCE", "Dynamics Source", juce::StringArray { "Off", "Input", "Sidechain" }, 0));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("DYNATTACK", "Dynamics Attack", attackRange, 5.f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("DYNRELEASE", "Dynamics Release", releaseRange, 150.f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("DYNDRIVE", "Dynamic Drive", -24.f, 24.f, 12.f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("DYNCUT", "Dynamic LowCut", 0.f, 4.f, 1.f));
+
+    return {params.begin(), params.end()};
+}
+ChainSettings getChainSettings (const juce::AudioProcessorValueTreeState& apvts)
+{
+    ChainSettings settings;
+
+    settings.lowCutFreq = apvts.getRawParameterValue ("LOWCUT")->load();
+    settings.highCutFreq = apvts.getRawParameterValue ("HIGHCUT")->load();
+    settings.tiltDb = apvts.getRawParameterValue ("TILT")->load();
+    settings.multiband.numBands = (int) apvts.getRawParameterValue ("BANDS")->load() + 1;
+
+    for (int i = 0; i < MultibandSettings::maxBands - 1; ++i)
+        settings.multiband.crossovers[i] = apvts.getRawParameterValue ("XOVER" + juce::String (i + 1))->load();
+
+    return settings;
+}
+
+ChainSettings getChainSettings (const ParameterSnapshot& snapshot)
+{
+    ChainSettings settings;
+
+    settings.lowCutFreq = snapshot[ParameterSnapshot::lowCut];
+    settings.highCutFreq = snapshot[ParameterSnapshot::highCut];
+    settings.tiltDb = snapshot[ParameterSnapshot::tilt];
+
+    return settings;
+}
+
+//==============================================================================
+// This creates new instances of the plugin..
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
+{
+    return new LemonDriveAudioProcessor();
+}
@@ -1,79 +1,150 @@
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin processor.
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-
-//==============================================================================
-/**
-*/
-struct ChainSettings
-{
-    float lowCutFreq { 0 };
-    float highCutFreq { 0 };
-};
-
-ChainSettings getChainSettings (juce::AudioProcessorValueTreeState& apvts);
-
-class LemonDriveAudioProcessor  : public juce::AudioProcessor
-{
-public:
-    //==============================================================================
-    LemonDriveAudioProcessor();
-    ~LemonDriveAudioProcessor() override;
-
-    //==============================================================================
-    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
-    void releaseResources() override;
-
-   #ifndef JucePlugin_PreferredChannelConfigurations
-    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
-   #endif
-
-    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-
-    //==============================================================================
-    juce::AudioProcessorEditor* createEditor() override;
-    bool hasEditor() const override;
-
-    //==============================================================================
-    const juce::String getName() const override;
-
-    bool acceptsMidi() const override;
-    bool producesMidi() const override;
-    bool isMidiEffect() const override;
-    double getTailLengthSeconds() const override;
-
-    //==============================================================================
-    int getNumPrograms() override;
-    int getCurrentProgram() override;
-    void setCurrentProgram (int index) override;
-    const juce::String getProgramName (int index) override;
-    void changeProgramName (int index, const juce::String& newName) override;
-
-    //==============================================================================
-    void getStateInformation (juce::MemoryBlock& destData) override;
-    void setStateInformation (const void* data, int sizeInBytes) override;
-    juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Parameters", createParameters()};
-private:
-    enum ChainPositions
-    {
-        LowCut,
-        HighCut
-    };
-    
-
-    void reset() override;
-    juce::dsp::LinkwitzRileyFilter<float> filter;
-    float _pi = juce::MathConstants<float>::pi;
-
-    juce::AudioProcessorValueTreeState::ParameterLayout createParameters();
-    //==============================================================================
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LemonDriveAudioProcessor)
-};
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin processor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DriveEngine.h"
+#include "SharedResources.h"
+#include "PresetBank.h"
+#include "LoadProfiler.h"
+
+//==============================================================================
+/**
+*/
+ChainSettings getChainSettings (const juce::AudioProcessorValueTreeState& apvts);
+ChainSettings getChainSettings (const ParameterSnapshot& snapshot);
+
+class LemonDriveAudioProcessor  : public juce::AudioProcessor,
+                                  private juce::Timer
+{
+public:
+    //==============================================================================
+    LemonDriveAudioProcessor();
+    ~LemonDriveAudioProcessor() override;
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
+    void releaseResources() override;
+
+   #ifndef JucePlugin_PreferredChannelConfigurations
+    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
+   #endif
+
+    bool supportsDoublePrecisionProcessing() const override { return true; }
+    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    //==============================================================================
+    juce::AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override;
+
+    //==============================================================================
+    const juce::String getName() const override;
+
+    bool acceptsMidi() const override;
+    bool producesMidi() const override;
+    bool isMidiEffect() const override;
+    double getTailLengthSeconds() const override;
+
+    //==============================================================================
+    int getNumPrograms() override;
+    int getCurrentProgram() override;
+    void setCurrentProgram (int index) override;
+    const juce::String getProgramName (int index) override;
+    void changeProgramName (int index, const juce::String& newName) override;
+
+    //==============================================================================
+    void getStateInformation (juce::MemoryBlock& destData) override;
+    void setStateInformation (const void* data, int sizeInBytes) override;
+    juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Parameters", createParameters()};
+
+    MeterFeed& getMeterFeed() noexcept { return meterFeed; }
+    LoadProfiler& getLoadProfiler() noexcept { return loadProfiler; }
+
+    //==============================================================================
+    enum class SnapshotSlot
+    {
+        a,
+        b
+    };
+
+    /** Stores the current knob settings in a slot. Once both slots are stored, MORPH
+        blends between them and the knobs no longer drive the sound until they are cleared.
+    */
+    void storeSnapshot (SnapshotSlot slot);
+    void clearSnapshots();
+    bool hasSnapshot (SnapshotSlot slot) const;
+
+private:
+    void reset() override;
+
+    template <typename SampleType>
+    void processWithEngine (juce::AudioBuffer<SampleType>& buffer, DriveEngine<SampleType>& engine);
+
+    // cached in the constructor so processBlock never looks parameters up by name
+    DriveParameters parameters;
+    MeterFeed meterFeed;
+    LoadProfiler loadProfiler;
+
+    // one engine per precision; only the one the host picked is prepared
+    DriveEngine<float> floatEngine { parameters, meterFeed, loadProfiler };
+    DriveEngine<double> doubleEngine { parameters, meterFeed, loadProfiler };
+
+    // Table shaper: while it is selected, tables are built on the message thread when CURVE
+    // changes and handed to the audio thread through pendingTable. The audio thread advertises
+    // the tables it is still reading in activeTableInUse/fadingTableInUse, and retainedTables
+    // only lets go of a table once it is neither pending nor in use.
+    void timerCallback() override;
+    bool isTableShaper() const noexcept;
+    void publishShaperTable (float curve);
+    void updateShaperTable();
+
+    SharedResources::Pointer sharedResources;
+    juce::CriticalSection tableLock;
+    juce::ReferenceCountedArray<ShaperTable> retainedTables;
+    std::atomic<ShaperTable*> pendingTable { nullptr };
+    std::atomic<ShaperTable*> activeTableInUse { nullptr }, fadingTableInUse { nullptr };
+    ShaperTableState tableState;
+
+    // Linear-phase LOWCUT/HIGHCUT: kernels are designed on the shared worker thread when the
+    // cutoffs change, and picked up by the audio thread in the same way as the shaper tables.
+    bool isLinearPhase() const noexcept;
+    ParameterSnapshot getFilterTargets() const;
+
+    CutKernelDesigner cutKernelDesigner;
+    LinearPhaseState cutKernelState;
+
+    // Diode table shaper: fetched for the new rate in prepareToPlay() and held until the next one
+    DiodeTableSet diodeTables;
+
+    PresetBank::Ptr presetBank;
+    int currentProgram = 0;
+
+    // A/B slots: edited on the message thread under snapshotLock, and published whole to
+    // the audio thread, which only ever reads the latest complete copy
+    void holdParameters (bool shouldHold);
+
+    juce::CriticalSection snapshotLock;
+    MorphState morphState;
+    TripleBuffer<MorphState> snapshotExchange;
+
+    // Hosts ask for the tail from any thread, the audio thread included, so it is worked out
+    // on the message thread whenever the filters or slots may have changed and only read here
+    void updateTailLength();
+
+    std::atomic<double> filterTailSeconds { 0.0 };
+
+    // The engine's latency moves with OVERSAMPLING and CUTMODE. setLatencySamples() notifies the
+    // host synchronously, so the audio thread only records it and timerCallback() reports it
+    std::atomic<int> engineLatency { 0 };
+
+    juce::AudioProcessorValueTreeState::ParameterLayout createParameters();
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LemonDriveAudioProcessor)
+};
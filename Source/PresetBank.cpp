@@ -0,0 +1,281 @@
+/*
+  ==============================================================================
+
+    PresetBank.cpp
+    Created: 22 Oct 2026 9:26:51am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+
+namespace
+{
+    // the state and the bank store what the user sees, so a parameter's range can be
+    // widened later without shifting old values
+    float getRawValue (const juce::AudioProcessorParameter& param, float normalised) noexcept
+    {
+        if (auto* ranged = dynamic_cast<const juce::RangedAudioParameter*> (&param))
+            return ranged->convertFrom0to1 (normalised);
+
+        return normalised;
+    }
+
+    float getNormalisedValue (const juce::AudioProcessorParameter& param, float raw) noexcept
+    {
+        if (auto* ranged = dynamic_cast<const juce::RangedAudioParameter*> (&param))
+            return ranged->convertTo0to1 (raw);
+
+        return juce::jlimit (0.0f, 1.0f, raw);
+    }
+
+    float readFloat (const char* data) noexcept
+    {
+        auto bits = juce::ByteOrder::littleEndianInt (data);
+        float value;
+        std::memcpy (&value, &bits, sizeof (value));
+        return value;
+    }
+
+    //==============================================================================
+    struct FactoryPreset
+    {
+        struct Setting
+        {
+            const char* parameterID;
+            float value;
+        };
+
+        const char* name;
+        Setting settings[8];    // anything not listed keeps its default
+    };
+
+    const FactoryPreset factoryPresets[] =
+    {
+        { "Default",            {} },
+        { "Edge of Breakup",    { { "DRIVE", -32.0f }, { "RANGE", 1.5f }, { "CURVE", 0.3f }, { "VOLUME", 0.95f } } },
+        { "Warm Crunch",        { { "DRIVE", -18.0f }, { "RANGE", 2.0f }, { "CURVE", 0.5f }, { "TILT", -3.0f },
+                                  { "HIGHCUT", 12000.0f } } },
+        { "Tight Bass Drive",   { { "DRIVE", -15.0f }, { "RANGE", 2.5f }, { "CURVE", 0.6f }, { "LOWCUT", 30.0f },
+                                  { "HIGHCUT", 6000.0f }, { "VOLUME", 0.8f } } },
+        { "Bright Fuzz",        { { "DRIVE", -4.0f }, { "RANGE", 4.0f }, { "CURVE", 0.85f }, { "TILT", 6.0f },
+                                  { "LOWCUT", 120.0f }, { "VOLUME", 0.6f } } },
+        { "Smooth Lead HQ",     { { "DRIVE", -8.0f }, { "RANGE", 3.0f }, { "CURVE", 0.7f }, { "TILT", 2.0f },
+                                  { "ADAA", 1.0f }, { "OVERSAMPLING", 2.0f }, { "VOLUME", 0.7f } } },
+    };
+
+    float getFactoryValue (const FactoryPreset& preset, const juce::AudioProcessorParameter& param)
+    {
+        auto value = getRawValue (param, param.getDefaultValue());
+
+        if (auto* withID = dynamic_cast<const juce::AudioProcessorParameterWithID*> (&param))
+            for (auto& setting : preset.settings)
+                if (setting.parameterID != nullptr && withID->paramID == setting.parameterID)
+                    value = setting.value;
+
+        return value;
+    }
+}
+
+//==============================================================================
+void StateFormat::write (const juce::AudioProcessor& processor, int program, const MorphState& slots, juce::MemoryBlock& dest)
+{
+    auto& params = processor.getParameters();
+
+    juce::MemoryOutputStream stream (dest, false);
+    stream.writeInt ((int) magic);
+    stream.writeShort ((short) version);
+    stream.writeShort ((short) params.size());
+    stream.writeInt (program);
+
+    for (auto* param : params)
+        stream.writeFloat (getRawValue (*param, param->getValue()));
+
+    stream.writeInt ((slots.hasA ? 1 : 0) | (slots.hasB ? 2 : 0));
+
+    for (auto* snapshot : { &slots.a, &slots.b })
+        for (auto value : snapshot->values)
+            stream.writeFloat (value);
+}
+
+bool StateFormat::read (juce::AudioProcessor& processor, const void* data, int sizeInBytes, int& program, MorphState& slots)
+{
+    auto* bytes = static_cast<const char*> (data);
+
+    if (data == nullptr || sizeInBytes < headerSize || juce::ByteOrder::littleEndianInt (bytes) != magic)
+        return false;
+
+    // later versions may add sections after these, which this one just ignores
+    auto blobVersion = (int) juce::ByteOrder::littleEndianShort (bytes + 4);
+    auto storedValues = (int) juce::ByteOrder::littleEndianShort (bytes + 6);
+    auto numValues = juce::jmin (storedValues, (sizeInBytes - headerSize) / 4);
+    program = (int) juce::ByteOrder::littleEndianInt (bytes + 8);
+
+    applyValues (processor, bytes + headerSize, numValues);
+
+    auto snapshotOffset = headerSize + 4 * storedValues;
+    slots.hasA = slots.hasB = false;
+
+    if (blobVersion >= 2 && sizeInBytes - snapshotOffset >= snapshotSectionSize)
+    {
+        auto* section = bytes + snapshotOffset;
+        auto flags = juce::ByteOrder::littleEndianInt (section);
+        section += 4;
+
+        for (auto* snapshot : { &slots.a, &slots.b })
+            for (auto& value : snapshot->values)
+            {
+                value = readFloat (section);
+                section += 4;
+            }
+
+        slots.hasA = (flags & 1) != 0;
+        slots.hasB = (flags & 2) != 0;
+    }
+
+    return true;
+}
+
+void StateFormat::applyValues (juce::AudioProcessor& processor, const char* values, int numValues)
+{
+    auto& params = processor.getParameters();
+
+    for (int i = 0; i < params.size(); ++i)
+    {
+        auto* param = params.getUnchecked (i);
+        auto value = i < numValues ? getNormalisedValue (*param, readFloat (values + 4 * i))
+                                   : param->getDefaultValue();
+
+        if (value != param->getValue())
+            param->setValueNotifyingHost (value);
+    }
+}
+
+//==============================================================================
+PresetBank* PresetBank::openOrCreate (const juce::AudioProcessor& processor)
+{
+    std::unique_ptr<PresetBank> bank (new PresetBank());
+    auto file = getDefaultFile();
+    auto factory = createFactoryBank (processor);
+
+    // the header holds the parameter count and the hash of the records, so a bank written by
+    // a build with other parameters or presets never matches this one's
+    auto isCurrent = [&bank, &factory] { return std::memcmp (bank->data, factory.getData(), (size_t) headerSize) == 0; };
+
+    if (! (bank->open (file) && isCurrent()))
+    {
+        bank.reset (new PresetBank());
+
+        // another host process may have the old file mapped, so swap the new one in whole
+        juce::TemporaryFile temp (file);
+
+        if (! (file.getParentDirectory().createDirectory().wasOk()
+                && temp.getFile().replaceWithData (factory.getData(), factory.getSize())
+                && temp.overwriteTargetFileWithTemporary()
+                && bank->open (file)))
+        {
+            bank->fallback = std::move (factory);
+            bank->attach (bank->fallback.getData(), bank->fallback.getSize());
+        }
+    }
+
+    return bank.release();
+}
+
+juce::File PresetBank::getDefaultFile()
+{
+    return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+             .getChildFile ("LemonDrive")
+             .getChildFile ("Factory.ldbank");
+}
+
+juce::String PresetBank::getName (int index) const
+{
+    if (! juce::isPositiveAndBelow (index, numPresets))
+        return {};
+
+    auto* name = getPreset (index);
+    int length = 0;
+
+    while (length < nameLength && name[length] != 0)
+        ++length;
+
+    return juce::String::fromUTF8 (name, length);
+}
+
+void PresetBank::apply (juce::AudioProcessor& processor, int index) const noexcept
+{
+    if (juce::isPositiveAndBelow (index, numPresets))
+        StateFormat::applyValues (processor, getPreset (index) + nameLength, numValues);
+}
+
+bool PresetBank::open (const juce::File& file)
+{
+    if (! file.existsAsFile())
+        return false;
+
+    auto mapped = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readOnly);
+
+    if (mapped->getData() == nullptr || ! attach (mapped->getData(), mapped->getSize()))
+        return false;
+
+    mappedFile = std::move (mapped);
+    return true;
+}
+
+bool PresetBank::attach (const void* bankData, size_t size)
+{
+    auto* bytes = static_cast<const char*> (bankData);
+
+    if (size < (size_t) headerSize
+         || juce::ByteOrder::littleEndianInt (bytes) != magic
+         || juce::ByteOrder::littleEndianShort (bytes + 4) != version)
+        return false;
+
+    auto values = (int) juce::ByteOrder::littleEndianShort (bytes + 6);
+    auto presets = (juce::uint32) juce::ByteOrder::littleEndianInt (bytes + 8);
+    auto stride = (size_t) nameLength + 4 * (size_t) values;
+
+    if (presets == 0 || presets > (juce::uint32) std::numeric_limits<int>::max()
+         || (size - (size_t) headerSize) / stride < presets)
+        return false;
+
+    data = bankData;
+    numValues = values;
+    numPresets = (int) presets;
+    presetSize = (int) stride;
+    return true;
+}
+
+juce::MemoryBlock PresetBank::createFactoryBank (const juce::AudioProcessor& processor)
+{
+    auto& params = processor.getParameters();
+    juce::MemoryBlock records, block;
+
+    {
+        juce::MemoryOutputStream stream (records, false);
+
+        for (auto& preset : factoryPresets)
+        {
+            char name[nameLength] = {};
+            juce::String (preset.name).copyToUTF8 (name, (size_t) nameLength);
+            stream.write (name, (size_t) nameLength);
+
+            for (auto* param : params)
+                stream.writeFloat (getFactoryValue (preset, *param));
+        }
+    }
+
+    {
+        juce::MemoryOutputStream stream (block, false);
+        stream.writeInt ((int) magic);
+        stream.writeShort ((short) version);
+        stream.writeShort ((short) params.size());
+        stream.writeInt ((int) juce::numElementsInArray (factoryPresets));
+        stream << juce::MD5 (records).getRawChecksumData();
+        stream << records;
+    }
+
+    return block;
+}
@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+    Created: 22 Oct 2026 9:26:51am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "MorphSnapshots.h"
+
+/*  Compact binary plugin state: a small versioned header followed by one raw
+    (denormalised) float per parameter, in the order the parameters were created.
+    New parameters are only ever appended, so older blobs simply stop early and
+    the rest keep their defaults.
+
+        uint32 magic, uint16 version, uint16 numValues, int32 program, float values[numValues]
+
+    Version 2 appends the A/B slots:
+
+        uint32 flags (bit 0 = A stored, bit 1 = B stored), float a[7], float b[7]
+
+    Everything is little-endian.
+*/
+struct StateFormat
+{
+    static constexpr juce::uint32 magic = 0x5453444c;    // "LDST"
+    static constexpr int version = 2;
+    static constexpr int headerSize = 12;
+    static constexpr int snapshotSectionSize = 4 + 2 * 4 * ParameterSnapshot::numValues;
+
+    static void write (const juce::AudioProcessor& processor, int program, const MorphState& slots, juce::MemoryBlock& dest);
+
+    /** Returns false, leaving the parameters alone, if the data isn't in this format.
+        Blobs without snapshots leave both slots empty.
+    */
+    static bool read (juce::AudioProcessor& processor, const void* data, int sizeInBytes, int& program, MorphState& slots);
+
+    /** Sets every parameter from a block of raw little-endian floats; parameters past
+        the end of the block go back to their defaults. Doesn't allocate.
+    */
+    static void applyValues (juce::AudioProcessor& processor, const char* values, int numValues);
+};
+
+//==============================================================================
+/*  Factory programs, stored in one bank file that every instance maps read-only:
+
+        uint32 magic, uint16 version, uint16 numValues, uint32 numPresets,
+        uint8 contentHash[16], numPresets x { char name[nameLength], float values[numValues] }
+
+    contentHash is the MD5 of the preset records. The file lives in the user's
+    application data folder and is written from the built-in presets whenever it
+    is missing, unreadable, or its header differs from the bank this build would
+    write, i.e. after parameters were added or the factory presets changed.
+    Switching program reads straight from the mapping, so it neither allocates
+    nor parses anything. The bank is immutable once opened; share it through
+    SharedResources::getPresetBank().
+*/
+class PresetBank : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<PresetBank>;
+
+    static constexpr juce::uint32 magic = 0x4250444c;    // "LDPB"
+    static constexpr int version = 2;
+    static constexpr int hashSize = 16;
+    static constexpr int headerSize = 12 + hashSize;
+    static constexpr int nameLength = 32;
+
+    /** Maps the bank file, writing the factory bank first if it is missing or stale.
+        It does file I/O, so call it from any thread but the audio thread, and without
+        holding a lock that other instances wait on.
+    */
+    static PresetBank* openOrCreate (const juce::AudioProcessor& processor);
+
+    static juce::File getDefaultFile();
+
+    int getNumPresets() const noexcept      { return numPresets; }
+    juce::String getName (int index) const;
+
+    /** Sets every parameter of the processor to this preset's values. */
+    void apply (juce::AudioProcessor& processor, int index) const noexcept;
+
+private:
+    PresetBank() = default;
+
+    bool open (const juce::File& file);
+    bool attach (const void* data, size_t size);
+    static juce::MemoryBlock createFactoryBank (const juce::AudioProcessor& processor);
+
+    const char* getPreset (int index) const noexcept
+    {
+        return static_cast<const char*> (data) + headerSize + (size_t) index * (size_t) presetSize;
+    }
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    juce::MemoryBlock fallback;     // used when the bank file can't be written or mapped
+    const void* data = nullptr;
+    int numPresets = 0, numValues = 0, presetSize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetBank)
+};
@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    ProfilerView.cpp
+    Created: 21 Oct 2026 3:05:19pm
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#include "ProfilerView.h"
+
+ProfilerView::ProfilerView (LoadProfiler& p)
+    : profiler (p)
+{
+    clearButton.onClick = [this] { profiler.clear(); timerCallback(); };
+    saveButton.onClick = [this] { saveReport(); };
+
+    addAndMakeVisible (clearButton);
+    addAndMakeVisible (saveButton);
+}
+
+void ProfilerView::visibilityChanged()
+{
+    if (isVisible())
+    {
+        timerCallback();
+        startTimerHz (4);
+    }
+    else
+    {
+        stopTimer();
+    }
+}
+
+void ProfilerView::timerCallback()
+{
+    report = profiler.getReport();
+    repaint();
+}
+
+void ProfilerView::saveReport()
+{
+    fileChooser = std::make_unique<juce::FileChooser> ("Save load profile",
+                                                       juce::File::getSpecialLocation (juce::File::userDocumentsDirectory)
+                                                           .getChildFile ("LemonDrive load profile.txt"),
+                                                       "*.txt");
+
+    fileChooser->launchAsync (juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+                                | juce::FileBrowserComponent::warnAboutOverwriting,
+                              [this] (const juce::FileChooser& chooser)
+                              {
+                                  auto file = chooser.getResult();
+
+                                  if (file != juce::File() && ! profiler.writeReport (file))
+                                      juce::AlertWindow::showMessageBoxAsync (juce::AlertWindow::WarningIcon, "LemonDrive",
+                                                                              "Couldn't write " + file.getFullPathName());
+                              });
+}
+
+void ProfilerView::resized()
+{
+    auto buttons = getLocalBounds().reduced (8).removeFromBottom (22);
+    saveButton.setBounds (buttons.removeFromRight (70));
+    buttons.removeFromRight (4);
+    clearButton.setBounds (buttons.removeFromRight (60));
+}
+
+void ProfilerView::paint (juce::Graphics& g)
+{
+    auto bounds = getLocalBounds().toFloat();
+
+    g.setColour (juce::Colours::black.withAlpha (0.8f));
+    g.fillRoundedRectangle (bounds, 6.0f);
+
+    auto area = bounds.reduced (10.0f);
+    area.removeFromBottom (28.0f);
+
+    auto percent = [] (double proportion) { return juce::String (proportion * 100.0, 1) + " %"; };
+    auto line = [&] (const juce::String& name, const juce::String& value, juce::Colour colour)
+    {
+        auto row = area.removeFromTop (15.0f);
+        g.setColour (juce::Colours::white);
+        g.drawText (name, row, juce::Justification::centredLeft);
+        g.setColour (colour);
+        g.drawText (value, row, juce::Justification::centredRight);
+    };
+
+    auto warnIf = [] (bool problem) { return problem ? juce::Colours::orangered : juce::Colours::yellow; };
+
+    g.setFont (12.0f);
+    line ("Average load", percent (report.averageLoad), warnIf (report.averageLoad > 0.5));
+    line ("Peak block", percent (report.peakProportion), warnIf (report.peakProportion > 1.0));
+    line ("Deadline overruns", juce::String (report.overruns), warnIf (report.overruns > 0));
+    line ("Denormal blocks", juce::String (report.denormalBlocks), warnIf (report.denormalBlocks > 0));
+
+   #if LEMONDRIVE_PROFILE_ALLOCATIONS
+    line ("Allocations", juce::String (report.allocations), warnIf (report.allocations > 0));
+   #endif
+
+    line ("Blocks", juce::String (report.blocks), juce::Colours::yellow);
+    area.removeFromTop (6.0f);
+
+    for (int stage = 0; stage < LoadProfiler::numStages; ++stage)
+        line (juce::String ("  ") + LoadProfiler::getStageName (stage), percent (report.meanStageProportion[stage]), juce::Colours::skyblue);
+
+    area.removeFromTop (8.0f);
+
+    // block times, 0 to 125 % of the deadline, on a log count scale so single overruns still show
+    auto graph = area;
+    g.setColour (juce::Colours::white.withAlpha (0.1f));
+    g.fillRect (graph);
+
+    juce::uint32 maxCount = 1;
+
+    for (auto count : report.blockHistogram)
+        maxCount = juce::jmax (maxCount, count);
+
+    auto binWidth = graph.getWidth() / (float) LoadProfiler::numBins;
+    auto scale = std::log1p ((float) maxCount);
+
+    for (int bin = 0; bin < LoadProfiler::numBins; ++bin)
+    {
+        auto count = report.blockHistogram[bin];
+
+        if (count == 0)
+            continue;
+
+        auto height = graph.getHeight() * std::log1p ((float) count) / scale;
+        g.setColour (bin >= juce::roundToInt (1.0 / LoadProfiler::binWidth) ? juce::Colours::orangered : juce::Colours::yellow);
+        g.fillRect (graph.getX() + (float) bin * binWidth, graph.getBottom() - height, juce::jmax (1.0f, binWidth - 1.0f), height);
+    }
+
+    auto deadlineX = graph.getX() + graph.getWidth() * (float) (1.0 / (LoadProfiler::numBins * LoadProfiler::binWidth));
+    g.setColour (juce::Colours::white);
+    g.drawVerticalLine (juce::roundToInt (deadlineX), graph.getY(), graph.getBottom());
+
+    g.setFont (10.0f);
+    g.drawText ("deadline", graph.withLeft (deadlineX + 3.0f), juce::Justification::topLeft);
+    g.drawText ("block time", graph.reduced (3.0f, 1.0f), juce::Justification::topLeft);
+}
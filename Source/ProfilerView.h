@@ -0,0 +1,41 @@
+/*
+  ==============================================================================
+
+    ProfilerView.h
+    Created: 21 Oct 2026 3:05:19pm
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "LoadProfiler.h"
+
+/*  Overlay showing the processor's LoadProfiler: the block-time histogram
+    against the deadline, the counters, and each stage's mean share of the
+    deadline. It only reads the profiler, a few times a second; turning the
+    profiler on and off is up to the editor.
+*/
+class ProfilerView : public juce::Component,
+                     private juce::Timer
+{
+public:
+    explicit ProfilerView (LoadProfiler& profiler);
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+    void visibilityChanged() override;
+
+private:
+    void timerCallback() override;
+    void saveReport();
+
+    LoadProfiler& profiler;
+    LoadProfiler::Report report;
+
+    juce::TextButton clearButton { "Clear" }, saveButton { "Save..." };
+    std::unique_ptr<juce::FileChooser> fileChooser;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProfilerView)
+};
@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    RenderCache.h
+    Created: 18 Oct 2026 9:12:48am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*  Pre-rendered knob frames, indexed by slider position.
+
+    All frames for one knob size live in a single atlas image laid out in rows.
+    Each frame is rendered the first time it is needed, so opening an editor
+    only pays for the positions the knobs are actually at.
+*/
+class KnobFilmstrip
+{
+public:
+    static constexpr int numFrames = 128;
+    static constexpr int framesPerRow = 16;
+
+    /** Draws one knob frame in its own (0, 0, width, height) space. */
+    using FrameRenderer = std::function<void (juce::Graphics&, int width, int height, float sliderPos)>;
+
+    void draw (juce::Graphics& g, juce::Rectangle<int> area, float sliderPos,
+               float rotaryStartAngle, float rotaryEndAngle, const FrameRenderer& renderFrame)
+    {
+        auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        auto& strip = getStrip (area.getWidth(), area.getHeight(), scale, rotaryStartAngle, rotaryEndAngle);
+        auto frame = juce::jlimit (0, numFrames - 1, juce::roundToInt (sliderPos * (float) (numFrames - 1)));
+        auto cell = getCell (strip, frame);
+
+        if (! strip.rendered[(size_t) frame])
+        {
+            juce::Graphics fg (strip.atlas);
+            fg.reduceClipRegion (cell);
+            fg.setOrigin (cell.getPosition());
+            fg.addTransform (juce::AffineTransform::scale (strip.scale));
+            fg.setColour (juce::Colours::black);    // what Slider::paint hands to the LookAndFeel
+            renderFrame (fg, area.getWidth(), area.getHeight(), (float) frame / (float) (numFrames - 1));
+            strip.rendered[(size_t) frame] = true;
+        }
+
+        g.drawImage (strip.atlas, area.getX(), area.getY(), area.getWidth(), area.getHeight(),
+                     cell.getX(), cell.getY(), cell.getWidth(), cell.getHeight());
+    }
+
+    void clear()    { strips.clear(); }
+
+private:
+    struct Strip
+    {
+        int width = 0, height = 0;
+        float scale = 1.0f, startAngle = 0.0f, endAngle = 0.0f;
+        int cellWidth = 0, cellHeight = 0;
+        juce::Image atlas;
+        std::vector<bool> rendered;
+    };
+
+    Strip& getStrip (int width, int height, float scale, float startAngle, float endAngle)
+    {
+        for (auto& s : strips)
+            if (s.width == width && s.height == height && s.scale == scale
+                 && s.startAngle == startAngle && s.endAngle == endAngle)
+                return s;
+
+        // a handful of sizes at most; drop the oldest rather than growing without bound
+        if (strips.size() >= 4)
+            strips.erase (strips.begin());
+
+        Strip s;
+        s.width = width;
+        s.height = height;
+        s.scale = scale;
+        s.startAngle = startAngle;
+        s.endAngle = endAngle;
+        s.cellWidth = juce::jmax (1, juce::roundToInt ((float) width * scale));
+        s.cellHeight = juce::jmax (1, juce::roundToInt ((float) height * scale));
+        s.atlas = juce::Image (juce::Image::ARGB, s.cellWidth * framesPerRow,
+                               s.cellHeight * ((numFrames + framesPerRow - 1) / framesPerRow), true);
+        s.rendered.assign ((size_t) numFrames, false);
+
+        strips.push_back (std::move (s));
+        return strips.back();
+    }
+
+    static juce::Rectangle<int> getCell (const Strip& s, int frame)
+    {
+        return { (frame % framesPerRow) * s.cellWidth, (frame / framesPerRow) * s.cellHeight, s.cellWidth, s.cellHeight };
+    }
+
+    std::vector<Strip> strips;
+};
+
+//==============================================================================
+/*  Measures how long the editor takes to paint, from the start of its paint()
+    to the end of paintOverChildren(), i.e. including every child that was redrawn.
+*/
+class FrameTimeCounter
+{
+public:
+    void frameStarted() noexcept
+    {
+        startMs = juce::Time::getMillisecondCounterHiRes();
+    }
+
+    void frameFinished() noexcept
+    {
+        auto ms = juce::Time::getMillisecondCounterHiRes() - startMs;
+        averageMs = numFrames == 0 ? ms : averageMs + 0.05 * (ms - averageMs);
+        worstMs = juce::jmax (worstMs, ms);
+        ++numFrames;
+    }
+
+    double getAverageMs() const noexcept    { return averageMs; }
+    double getWorstMs() const noexcept      { return worstMs; }
+    juce::int64 getNumFrames() const noexcept { return numFrames; }
+
+    juce::String getDescription() const
+    {
+        return juce::String (averageMs, 3) + " ms avg, " + juce::String (worstMs, 3)
+                + " ms worst, " + juce::String (numFrames) + " frames";
+    }
+
+private:
+    double startMs = 0.0, averageMs = 0.0, worstMs = 0.0;
+    juce::int64 numFrames = 0;
+};
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    ShaperTable.cpp
+    Created: 17 Oct 2026 2:41:37pm
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#include "ShaperTable.h"
+#include "Core/DriveShaper.h"
+
+ShaperTable::ShaperTable (float c)
+    : curve (c),
+      k (juce::MathConstants<float>::pi / (1.0f - c)),
+      scaler ((float) (numPoints - 1) / (2.0f * maxInput)),
+      table ((size_t) numPoints + 1)
+{
+    for (int i = 0; i < numPoints; ++i)
+    {
+        auto v = -maxInput + (float) i / scaler;
+        table[(size_t) i] = 2.0f / juce::MathConstants<float>::pi * std::atan (k * v);
+    }
+
+    // guard point so the interpolation never reads past the end
+    table[(size_t) numPoints] = table[(size_t) numPoints - 1];
+}
+
+float ShaperTable::processSample (float v) const noexcept
+{
+    auto pos = (v + maxInput) * scaler;
+
+    if (pos >= 0.0f && pos < (float) (numPoints - 1))
+    {
+        auto index = (int) pos;
+        auto frac = pos - (float) index;
+        auto y0 = table[(size_t) index];
+
+        return y0 + frac * (table[(size_t) index + 1] - y0);
+    }
+
+    return 2.0f / juce::MathConstants<float>::pi * lemondrive::DriveShaper::fastAtan (k * v);
+}
+
+template <typename SampleType>
+void ShaperTable::process (SampleType* data, int numSamples, SampleType preGain, SampleType outGain) const noexcept
+{
+    for (int i = 0; i < numSamples; ++i)
+        data[i] = outGain * (SampleType) processSample ((float) (preGain * data[i]));
+}
+
+template <typename SampleType>
+void ShaperTable::processCrossfade (const ShaperTable& from, const ShaperTable& to, SampleType* data, int numSamples,
+                                    SampleType preGain, SampleType outGain, int fadePosition, int fadeLength) noexcept
+{
+    auto step = (SampleType) 1 / (SampleType) fadeLength;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto alpha = juce::jmin ((SampleType) 1, (SampleType) (fadePosition + i) * step);
+        auto v = (float) (preGain * data[i]);
+        auto a = (SampleType) from.processSample (v);
+
+        data[i] = outGain * (a + alpha * ((SampleType) to.processSample (v) - a));
+    }
+}
+
+template void ShaperTable::process (float*, int, float, float) const noexcept;
+template void ShaperTable::process (double*, int, double, double) const noexcept;
+template void ShaperTable::processCrossfade (const ShaperTable&, const ShaperTable&, float*, int, float, float, int, int) noexcept;
+template void ShaperTable::processCrossfade (const ShaperTable&, const ShaperTable&, double*, int, double, double, int, int) noexcept;
@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    ShaperTable.h
+    Created: 17 Oct 2026 2:41:37pm
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/*  Interpolated lookup table of the drive transfer function for one CURVE value,
+
+        table (v) = 2/pi * atan (pi/(1-curve) * v),   v = gain * range * x
+
+    Tables are immutable once built, so the audio thread can read them without
+    locking. Inputs outside the table range fall back to the fast atan kernel.
+*/
+class ShaperTable : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<ShaperTable>;
+
+    static constexpr int numPoints = 8193;
+    static constexpr float maxInput = 4.0f;
+
+    /** Builds the table, so never call this on the audio thread. */
+    explicit ShaperTable (float curve);
+
+    float getCurve() const noexcept     { return curve; }
+
+    float processSample (float v) const noexcept;
+
+    /** data = outGain * table (preGain * data). Instantiated for float and double; the
+        table itself is always float, so the lookup accuracy is the same for both.
+    */
+    template <typename SampleType>
+    void process (SampleType* data, int numSamples, SampleType preGain, SampleType outGain) const noexcept;
+
+    /** Same as process(), but blends linearly from one table to another over fadeLength samples. */
+    template <typename SampleType>
+    static void processCrossfade (const ShaperTable& from, const ShaperTable& to, SampleType* data, int numSamples,
+                                  SampleType preGain, SampleType outGain, int fadePosition, int fadeLength) noexcept;
+
+private:
+    float curve, k, scaler;
+    std::vector<float> table;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ShaperTable)
+};
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    SharedResources.cpp
+    Created: 21 Oct 2026 11:04:12am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#include "SharedResources.h"
+
+ShaperTable::Ptr SharedResources::getShaperTable (float curve)
+{
+    // keyed on the exact bits, so two curves that print the same never share a table
+    juce::uint32 bits;
+    std::memcpy (&bits, &curve, sizeof (bits));
+
+    return getObject<ShaperTable> ("ShaperTable/" + juce::String::toHexString ((int) bits),
+                                   [curve] { return new ShaperTable (curve); });
+}
+
+CutKernel::Ptr SharedResources::getCutKernel (CutKernel::Type type, float cutoff, double sampleRate)
+{
+    juce::uint32 bits;
+    std::memcpy (&bits, &cutoff, sizeof (bits));
+
+    auto key = juce::String (type == CutKernel::Type::lowCut ? "LowCutKernel/" : "HighCutKernel/")
+                 + juce::String::toHexString ((int) bits) + "/" + juce::String (sampleRate);
+
+    return getObject<CutKernel> (key, [type, cutoff, sampleRate] { return new CutKernel (type, cutoff, sampleRate); });
+}
+
+SharedDiodeTable::Ptr SharedResources::getDiodeTable (double sampleRate)
+{
+    return getObject<SharedDiodeTable> ("DiodeTable/" + juce::String (sampleRate),
+                                        [sampleRate] { return new SharedDiodeTable (sampleRate); });
+}
+
+PresetBank::Ptr SharedResources::getPresetBank (const juce::AudioProcessor& processor)
+{
+    if (auto bank = findObject<PresetBank> ("PresetBank"))
+        return bank;
+
+    // two instances may both get here and open the file; the first one stored is the one kept
+    PresetBank::Ptr opened (PresetBank::openOrCreate (processor));
+    return getObject<PresetBank> ("PresetBank", [&opened] { return opened.get(); });
+}
+
+juce::ThreadPool& SharedResources::getWorkerPool()
+{
+    const juce::ScopedLock sl (workerLock);
+
+    if (workerPool == nullptr)
+        workerPool = std::make_unique<juce::ThreadPool> (1);
+
+    return *workerPool;
+}
+
+juce::Image SharedResources::getImage (const void* data, int dataSize)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    auto& image = images[data];
+
+    if (image.isNull())
+        image = juce::ImageFileFormat::loadFrom (data, (size_t) dataSize);
+
+    return image;
+}
+
+juce::Image SharedResources::getScaledImage (const juce::Image& source, int width, int height)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    // sizes no editor is showing any more
+    scaledImages.erase (std::remove_if (scaledImages.begin(), scaledImages.end(),
+                                        [] (const ScaledImage& s) { return s.image.getReferenceCount() == 1; }),
+                        scaledImages.end());
+
+    for (auto& s : scaledImages)
+        if (s.source == source && s.width == width && s.height == height)
+            return s.image;
+
+    juce::Image scaled (juce::Image::ARGB, width, height, true);
+
+    {
+        juce::Graphics g (scaled);
+        g.drawImageWithin (source, 0, 0, width, height, juce::RectanglePlacement::stretchToFit);
+    }
+
+    scaledImages.push_back ({ source, width, height, scaled });
+    return scaled;
+}
+
+KnobFilmstrip& SharedResources::getKnobFilmstrip() noexcept
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    return knobFilmstrip;
+}
@@ -0,0 +1,150 @@
+/*
+  ==============================================================================
+
+    SharedResources.h
+    Created: 21 Oct 2026 11:04:12am
+    Author:  irishill
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "RenderCache.h"
+#include "ShaperTable.h"
+#include "CutKernel.h"
+#include "PresetBank.h"
+#include "Core/DiodeClipper.h"
+
+/** A lemondrive::DiodeTable that SharedResources can hand out and refcount. */
+class SharedDiodeTable : public juce::ReferenceCountedObject,
+                         public lemondrive::DiodeTable
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<SharedDiodeTable>;
+    using DiodeTable::DiodeTable;
+};
+
+/*  Immutable assets shared by every LemonDrive instance in the process.
+
+    Hold it through a SharedResources::Pointer. The first instance creates the
+    registry and the last one to go away deletes it, and juce::SharedResourcePointer
+    serialises both, so hosts that instantiate plugins in parallel are safe.
+
+    Anything built here must never change after it is handed out. Shared objects
+    are refcounted, and entries nobody else holds any more are dropped the next
+    time something new is requested.
+*/
+class SharedResources
+{
+public:
+    using Pointer = juce::SharedResourcePointer<SharedResources>;
+
+    SharedResources() = default;
+
+    //==============================================================================
+    /** Returns the object stored under this key, building it with create() if nobody
+        has it yet. Never call this on the audio thread: it locks and may allocate.
+    */
+    template <typename ObjectType, typename Creator>
+    juce::ReferenceCountedObjectPtr<ObjectType> getObject (const juce::String& key, Creator&& create)
+    {
+        const juce::ScopedLock sl (objectLock);
+
+        for (auto it = objects.begin(); it != objects.end();)
+            it = it->second->getReferenceCount() == 1 ? objects.erase (it) : std::next (it);
+
+        auto& entry = objects[key];
+
+        if (entry == nullptr)
+            entry = create();
+
+        auto* object = dynamic_cast<ObjectType*> (entry.get());
+        jassert (object != nullptr);    // two different types stored under the same key
+        return object;
+    }
+
+    /** The table shaper's lookup table for one CURVE value. */
+    ShaperTable::Ptr getShaperTable (float curve);
+
+    /** A linear-phase LOWCUT or HIGHCUT kernel for one cutoff at one sample rate. */
+    CutKernel::Ptr getCutKernel (CutKernel::Type type, float cutoff, double sampleRate);
+
+    /** The diode shaper's solution table for one drive-stage rate, oversampling included. */
+    SharedDiodeTable::Ptr getDiodeTable (double sampleRate);
+
+    /** The factory preset bank. Opening it does file I/O, which runs outside the registry's
+        lock so other instances aren't held up; any thread but the audio thread.
+    */
+    PresetBank::Ptr getPresetBank (const juce::AudioProcessor& processor);
+
+    /** One background thread for building assets, shared by every instance and only started
+        the first time one of them asks for it. Any thread but the audio thread.
+    */
+    juce::ThreadPool& getWorkerPool();
+
+    //==============================================================================
+    /** An embedded image, decoded once per process. Message thread only. */
+    juce::Image getImage (const void* data, int dataSize);
+
+    /** source stretched to exactly width x height, shared by every editor showing it at
+        that size. Message thread only.
+    */
+    juce::Image getScaledImage (const juce::Image& source, int width, int height);
+
+    /** Knob frames rendered by one editor are reused by all of them. Message thread only. */
+    KnobFilmstrip& getKnobFilmstrip() noexcept;
+
+private:
+    template <typename ObjectType>
+    juce::ReferenceCountedObjectPtr<ObjectType> findObject (const juce::String& key)
+    {
+        const juce::ScopedLock sl (objectLock);
+        auto it = objects.find (key);
+        return it != objects.end() ? dynamic_cast<ObjectType*> (it->second.get()) : nullptr;
+    }
+
+    struct ScaledImage
+    {
+        juce::Image source;
+        int width, height;
+        juce::Image image;
+    };
+
+    juce::CriticalSection objectLock;
+    std::map<juce::String, juce::ReferenceCountedObjectPtr<juce::ReferenceCountedObject>> objects;
+
+    std::map<const void*, juce::Image> images;
+    std::vector<ScaledImage> scaledImages;
+    KnobFilmstrip knobFilmstrip;
+
+    // last, so its thread stops before anything it could be building for goes away
+    juce::CriticalSection workerLock;
+    std::unique_ptr<juce::ThreadPool> workerPool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SharedResources)
+};
+
+//==============================================================================
+/*  Background image scaled once per editor size and display scale. Editors of the
+    same size share the scaled copy.
+*/
+class ScaledBackground
+{
+public:
+    void draw (juce::Graphics& g, juce::Rectangle<int> area, const juce::Image& source)
+    {
+        auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        auto width = juce::jmax (1, juce::roundToInt ((float) area.getWidth() * scale));
+        auto height = juce::jmax (1, juce::roundToInt ((float) area.getHeight() * scale));
+
+        if (cached.isNull() || cached.getWidth() != width || cached.getHeight() != height)
+            cached = resources->getScaledImage (source, width, height);
+
+        g.drawImage (cached, area.toFloat());
+    }
+
+private:
+    SharedResources::Pointer resources;
+    juce::Image cached;
+};